@@ -0,0 +1,224 @@
+/// \file digitize.cc
+/// \brief Compiled replacement of processing() in signalsLiteNew.C
+///
+/// Usage: digitize [-t threshold] [-p pars.txt] [-s shape.txt] [-o oversampling]
+///                 [-j threads] [-r seed] [-w pre:post] [-l lsb] [-c fraction]
+///                 [-n rms[:bandwidth]] [-N spectrum.txt] file
+/// Reads the ChNN trees of file.root written by preprocessing() and writes
+/// the waves tree in the same file. The pulse shape is Signal() of the
+/// macro unless a file with its three parameters (as Gp) is given.
+/// The channels are processed in parallel (all the cores by default); the
+/// random numbers of a channel depend only on the seed and on the channel,
+/// so the output does not depend on the number of threads.
+/// With -w the waveform from pre samples before each crossing to post
+/// samples after is saved in the snippets tree, in ADC counts of lsb
+/// (default 0.001 single cell amplitudes); WaveSnippet::Decode() gives the
+/// samples back. -c sets the constant fraction of TimeCFD (default 0.2).
+/// -n adds baseline noise of the given rms (single cell amplitudes) with a
+/// one-pole spectrum of the given bandwidth (GHz, default 0.2), or with the
+/// spectrum tabulated in the -N file (frequency in GHz, density).
+
+#include "PulseTemplate.hh"
+#include "WaveformDigitizer.hh"
+#include "DigitizerIO.hh"
+#include "TabulatedSampler.hh"
+#include "TaskPool.hh"
+#include "NoiseGenerator.hh"
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <mutex>
+#include <unistd.h>
+
+namespace {
+	const char* kUsage = " [-t threshold] [-p pars.txt] [-s shape.txt] [-o oversampling] [-j threads] [-r seed] [-w pre:post] [-l lsb] [-c fraction] [-n rms[:bandwidth]] [-N spectrum.txt] file";
+
+	// State of one worker thread
+	struct Worker{
+		TFile* file = nullptr;
+		std::unique_ptr<WaveformDigitizer> digitizer;
+		std::mt19937_64 engine;
+		std::vector<double> block;
+	};
+}
+
+int main(int argc, char** argv){
+	double threshold = 0.1;
+	std::string parsFile = "../../../pars.txt";
+	std::string shapeFile;
+	int oversampling = 16;
+	int nThreads = 0;
+	unsigned long seed = 4357;
+	int snapPre = -1, snapPost = 0;
+	double lsb = 0.001;
+	double cfdFraction = 0.2;
+	double noiseRMS = 0, bandwidth = 0.2;
+	std::string spectrumFile;
+
+	int opt;
+	while((opt = getopt(argc, argv, "t:p:s:o:j:r:w:l:c:n:N:")) != -1){
+		switch(opt){
+			case 't': threshold = std::atof(optarg); break;
+			case 'p': parsFile = optarg; break;
+			case 's': shapeFile = optarg; break;
+			case 'o': oversampling = std::atoi(optarg); break;
+			case 'j': nThreads = std::atoi(optarg); break;
+			case 'r': seed = std::strtoul(optarg, nullptr, 10); break;
+			case 'w':
+				if(std::sscanf(optarg, "%d:%d", &snapPre, &snapPost) != 2 || snapPre < 0){
+					std::cerr << "Invalid snippet size " << optarg << ", expected pre:post" << std::endl;
+					return 1;
+				}
+				break;
+			case 'l': lsb = std::atof(optarg); break;
+			case 'c': cfdFraction = std::atof(optarg); break;
+			case 'n':
+				if(std::sscanf(optarg, "%lf:%lf", &noiseRMS, &bandwidth) < 1 || noiseRMS < 0 || bandwidth <= 0){
+					std::cerr << "Invalid noise " << optarg << ", expected rms[:bandwidth]" << std::endl;
+					return 1;
+				}
+				break;
+			case 'N': spectrumFile = optarg; break;
+			default:
+				std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+				return 1;
+		}
+	}
+	if(optind >= argc){
+		std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+		return 1;
+	}
+	std::string file = std::string(argv[optind]) + ".root";
+
+	// Gain smearing of each avalanche, same density as the TF1 in processing()
+	double pars[3] = {1, 0.1, 0};
+	bool smearing = false;
+	std::ifstream myfile(parsFile);
+	if(myfile.is_open()){
+		myfile >> pars[0] >> pars[1] >> pars[2];
+		smearing = !myfile.fail();
+	}
+	if(!smearing) std::cerr << "Warning: cannot read " << parsFile << ", no gain smearing" << std::endl;
+	TabulatedSampler sampler([&pars](double x){
+		if(x < pars[0]) return std::exp(-(x - pars[0]) * (x - pars[0]) / 2 / (pars[1] * pars[1] + 2 * x * pars[2]));
+		return std::exp(-0.5 * (x - pars[0]) * (x - pars[0]) / pars[1] / pars[1]);
+	}, 0, 2);
+
+	PulseTemplate pulse(0.1, 199, oversampling);
+	if(!shapeFile.empty() && !pulse.Load(shapeFile)) return 1;
+
+	std::unique_ptr<NoiseGenerator> noise;
+	if(noiseRMS > 0){
+		noise.reset(new NoiseGenerator(pulse.GetPitch(), noiseRMS, bandwidth));
+		if(!spectrumFile.empty() && !noise->Load(spectrumFile)) return 1;
+	}
+
+	ROOT::EnableThreadSafety();
+
+	// Channels, the longest first
+	std::vector<std::pair<int, std::string>> channels;
+	std::vector<long> entries;
+	{
+		std::unique_ptr<TFile> F(TFile::Open(file.c_str()));
+		if(!F || F->IsZombie()){
+			std::cerr << "Cannot open " << file << std::endl;
+			return 1;
+		}
+		channels = GetChannelTrees(F.get());
+		for(auto& channel : channels) entries.push_back(((TTree*) F->Get(channel.second.c_str()))->GetEntries());
+	}
+	std::vector<int> order(channels.size());
+	for(size_t i = 0; i < order.size(); i++) order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&entries](int a, int b){return entries[a] > entries[b];});
+
+	TaskPool pool(nThreads);
+	std::vector<Worker> workers(pool.GetNbOfThreads());
+	std::vector<std::vector<WaveSignal>> results(channels.size());
+	std::vector<std::vector<WaveSnippet>> snippets(channels.size());
+	std::mutex printMutex;
+
+	const int kBlock = 4096;
+	std::vector<TaskPool::Task> tasks;
+	for(int c : order){
+		tasks.push_back([&, c](int w){
+			Worker& worker = workers[w];
+			if(!worker.file){
+				worker.file = TFile::Open(file.c_str());
+				worker.digitizer.reset(new WaveformDigitizer(&pulse, threshold));
+				worker.digitizer->SetCFDFraction(cfdFraction);
+				worker.digitizer->SetNoise(noise.get());
+				if(snapPre >= 0) worker.digitizer->SetSnapshot(snapPre, snapPost, lsb);
+				worker.block.assign(kBlock, 1.);
+			}
+			int channel = channels[c].first;
+			std::seed_seq sequence{(unsigned long) seed, (unsigned long) channel};
+			worker.engine.seed(sequence);
+			std::uniform_real_distribution<double> flat(0, 1);
+
+			TTree* T = (TTree*) worker.file->Get(channels[c].second.c_str());
+			long N = T->GetEntries();
+			{
+				HitReader reader(T);
+				WaveformDigitizer& digitizer = *worker.digitizer;
+				digitizer.SetChannel(channel);
+				if(noise) digitizer.SetNoiseSeed(worker.engine());
+				// smearing factors are generated in blocks
+				for(long i = 0; i < N; i += kBlock){
+					int n = std::min<long>(kBlock, N - i);
+					if(smearing){
+						for(int k = 0; k < n; k++) worker.block[k] = flat(worker.engine);
+						sampler.Sample(worker.block.data(), n);
+					}
+					for(int k = 0; k < n; k++) digitizer.AddHit(reader.Get(i + k), worker.block[k]);
+				}
+				digitizer.Flush();
+				results[c].swap(digitizer.GetSignals());
+				digitizer.GetSignals().clear();
+				snippets[c].swap(digitizer.GetSnippets());
+				digitizer.GetSnippets().clear();
+			}
+			delete T;
+
+			std::lock_guard<std::mutex> lock(printMutex);
+			std::cout << channels[c].second << ": " << N << " hits, " << results[c].size() << " signals" << std::endl;
+		});
+	}
+	pool.Run(tasks);
+	for(auto& worker : workers) delete worker.file;
+
+	// Merge in channel order
+	TFile* F = TFile::Open(file.c_str(), "UPDATE");
+	if(!F || F->IsZombie()){
+		std::cerr << "Cannot open " << file << " for writing" << std::endl;
+		return 1;
+	}
+	TTree* Twaves = new TTree("waves", "signals");
+	{
+		WaveWriter writer(Twaves);
+		for(auto& signals : results) for(auto& signal : signals) writer.Fill(signal);
+	}
+	F->cd();
+	Twaves->Write("waves", TObject::kOverwrite);
+	if(snapPre >= 0){
+		TTree* Tsnippets = new TTree("snippets", "waveform snippets");
+		SnippetWriter snippetWriter(Tsnippets);
+		for(auto& channel : snippets) for(auto& snippet : channel) snippetWriter.Fill(snippet);
+		Tsnippets->Write("snippets", TObject::kOverwrite);
+	}
+	F->Close();
+	return 0;
+}
+
+
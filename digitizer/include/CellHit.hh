@@ -0,0 +1,49 @@
+/// \file  CellHit.hh
+/// \brief Definition of the CellHit and WaveSignal records
+
+#ifndef CellHit_h
+#define CellHit_h 1
+
+/// One fired cell of a readout channel, with the information of the event
+/// that produced it (the branches of the ChNN trees)
+
+struct CellHit{
+	double time = 0;   // ns
+	double timeEv = 0; // ns, time since GunTime
+	double trackLength = 0;
+	double thetaIn = 0;
+	int element = 0; // copy number of the element (0 for a single element)
+	int cell = 0;
+	int DN = 0;
+	int secondaryID = 0;
+	int bounce = 0;
+	int eventID = 0;
+	int surfIn = 0;
+};
+
+/// One discriminated signal (the branches of the waves tree)
+
+struct WaveSignal{
+	int channel = 0;
+	int DN = 0;
+	double amplitude = 0;
+	double amplitudeNoSmearing = 0;
+	double charge = 0;
+	double chargeNoSmearing = 0;
+	double time = 0;
+	double timeEv = 0;
+	double deltaTime = 0;
+	double timeLE = 0;  // leading edge, interpolated between samples
+	double timeCFD = 0; // constant fraction of the amplitude, interpolated
+	double timeOverThreshold = 0;
+	double trackLength = 0;
+	double thetaIn = 0;
+	int secondaryID = 0;
+	int bounce = 0;
+	int eventID = 0;
+	int surfIn = 0;
+};
+
+#endif
+
+
@@ -0,0 +1,41 @@
+/// \file  ChannelMap.hh
+/// \brief Definition of the ChannelMap class
+
+#ifndef ChannelMap_h
+#define ChannelMap_h 1
+
+#include <vector>
+#include <string>
+
+/// Map from (element copy number, cell) to readout channel
+///
+/// The map is a text file with one range of cells per line:
+///   element  firstCell  lastCell  channel
+/// lastCell = -1 extends the range to all the following cells. Without a
+/// file every element is read out as one channel (channel = element).
+/// Each mapped cell has also a dense index inside its channel, used to keep
+/// the per-cell state without allocating the whole array.
+
+class ChannelMap{
+	public:
+		ChannelMap();
+		~ChannelMap();
+
+		bool Load(const std::string& fileName);
+
+		// False if the cell is not read out
+		bool Map(int element, int cell, int& channel, int& index) const;
+
+		inline bool IsDefault() const {return fRanges.empty();}
+
+	private:
+		struct Range{
+			int element, first, last, channel, offset;
+		};
+
+		std::vector<Range> fRanges; // sorted by element and first cell
+};
+
+#endif
+
+
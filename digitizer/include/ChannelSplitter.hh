@@ -0,0 +1,43 @@
+/// \file  ChannelSplitter.hh
+/// \brief Definition of the ChannelSplitter class
+
+#ifndef ChannelSplitter_h
+#define ChannelSplitter_h 1
+
+#include "CellHit.hh"
+#include "ChannelMap.hh"
+
+#include <vector>
+#include <functional>
+
+/// Splitter of the time ordered hit stream in per-channel streams
+///
+/// Each hit is mapped to its channel and dropped if the same cell fired
+/// less than the dead time before, as preprocessing() in signalsLiteNew.C
+/// does. The firing time of the cells is kept per channel in arrays that
+/// grow with the cells actually seen.
+
+class ChannelSplitter{
+	public:
+		typedef std::function<void(int channel, const CellHit& hit)> Output;
+
+		ChannelSplitter(const ChannelMap* map, Output output, double deadTime = 20);
+		~ChannelSplitter();
+
+		void Add(const CellHit& hit);
+
+		inline long GetNbOfAccepted() const {return fAccepted;}
+		inline long GetNbOfDead() const {return fDead;}
+		inline long GetNbOfUnmapped() const {return fUnmapped;}
+
+	private:
+		const ChannelMap* fMap;
+		Output fOutput;
+		double fDeadTime;
+		std::vector<std::vector<double>> fLastTime; // [channel][index]
+		long fAccepted, fDead, fUnmapped;
+};
+
+#endif
+
+
@@ -0,0 +1,119 @@
+/// \file  DigitizerIO.hh
+/// \brief Definition of the ROOT readers and writers of the digitizer
+
+#ifndef DigitizerIO_h
+#define DigitizerIO_h 1
+
+#include "CellHit.hh"
+#include "WaveSnippet.hh"
+
+#include <vector>
+#include <string>
+#include <utility>
+
+class TFile;
+class TTree;
+
+/// Reader of the simulation output tree (T of data.root), one event at a time
+
+class EventReader{
+	public:
+		// throws std::runtime_error if the tree has no fired cells
+		EventReader(TTree* tree);
+		~EventReader();
+
+		long GetEntries();
+		// Fired cells of the event, the dark noise ones only if darkNoise
+		const std::vector<CellHit>& Get(long i, bool darkNoise);
+
+	private:
+		TTree* fTree;
+		std::vector<int>* fCells;
+		std::vector<int>* fDNflag;
+		std::vector<double>* fCellTime;
+		double fGunTime;
+		CellHit fEvent;
+		std::vector<CellHit> fHits;
+};
+
+/// Writer of the time ordered tree (T) written by ordering()
+
+class HitWriter{
+	public:
+		HitWriter(TTree* tree);
+		~HitWriter();
+
+		void Fill(const CellHit& hit);
+
+	private:
+		TTree* fTree;
+		CellHit fHit;
+};
+
+/// Writer of the per-channel hit trees (ChNN) written by preprocessing()
+
+class ChannelWriter{
+	public:
+		ChannelWriter(TFile* file);
+		~ChannelWriter();
+
+		void Fill(int channel, const CellHit& hit);
+		// Number of channel trees written
+		int Write();
+
+	private:
+		TFile* fFile;
+		std::vector<TTree*> fTrees;
+		CellHit fHit;
+};
+
+/// Reader of the time ordered tree (T) and of the per-channel hit trees
+/// (ChNN) written by preprocessing()
+
+class HitReader{
+	public:
+		HitReader(TTree* tree);
+		~HitReader();
+
+		long GetEntries();
+		const CellHit& Get(long i);
+
+	private:
+		TTree* fTree;
+		CellHit fHit;
+};
+
+/// Writer of the waves tree
+
+class WaveWriter{
+	public:
+		WaveWriter(TTree* tree);
+		~WaveWriter();
+
+		void Fill(const WaveSignal& signal);
+
+	private:
+		TTree* fTree;
+		WaveSignal fSignal;
+};
+
+/// Writer of the waveform snippets tree
+
+class SnippetWriter{
+	public:
+		SnippetWriter(TTree* tree);
+		~SnippetWriter();
+
+		void Fill(const WaveSnippet& snippet);
+
+	private:
+		TTree* fTree;
+		WaveSnippet fSnippet;
+};
+
+/// Channel number and name of the ChNN trees of a file, in channel order
+std::vector<std::pair<int, std::string>> GetChannelTrees(TFile* file);
+
+#endif
+
+
@@ -0,0 +1,49 @@
+/// \file  HitSorter.hh
+/// \brief Definition of the HitSorter class
+
+#ifndef HitSorter_h
+#define HitSorter_h 1
+
+#include "CellHit.hh"
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <future>
+#include <cstdio>
+
+/// External merge sort of cell hits by time
+///
+/// The hits are collected in a buffer of fixed size; a full buffer is sorted
+/// and spilled to a temporary file (a run) by a background thread while the
+/// next one is filled. Merge() combines the runs with a k-way heap merge, so
+/// the output is strictly time ordered (ties keep the input order) and the
+/// memory is bounded by the buffer plus one read block per run.
+
+class HitSorter{
+	public:
+		HitSorter(size_t bufferSize = 1 << 22, std::string tmpDir = "");
+		~HitSorter();
+
+		void Add(const CellHit& hit);
+		void Merge(std::function<void(const CellHit&)> output);
+
+		inline size_t GetNbOfHits() const {return fNbOfHits;}
+		inline size_t GetNbOfRuns() const {return fRuns.size();}
+
+	private:
+		void Spill();
+		FILE* OpenTemporary();
+		static void SortAndWrite(std::vector<CellHit>* hits, FILE* file);
+
+		size_t fBufferSize;
+		std::string fTmpDir;
+		size_t fNbOfHits;
+		std::vector<CellHit> fBuffer, fSpilling;
+		std::future<void> fPending;
+		std::vector<FILE*> fRuns;
+};
+
+#endif
+
+
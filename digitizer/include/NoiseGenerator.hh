@@ -0,0 +1,50 @@
+/// \file  NoiseGenerator.hh
+/// \brief Definition of the NoiseGenerator class
+
+#ifndef NoiseGenerator_h
+#define NoiseGenerator_h 1
+
+#include <vector>
+#include <string>
+#include <functional>
+
+/// Coloured electronic noise of the digitizer baseline
+///
+/// A few blocks of noise with the given one-sided power spectrum are
+/// synthesised once with an inverse FFT: the amplitude of each frequency
+/// bin is fixed by the spectrum and its phase is random. The blocks are
+/// periodic, so the noise of a readout block is one of them read from a
+/// random offset with a random sign: a copy per block instead of a filtered
+/// random number per sample. The correlations longer than a block are lost.
+///
+/// The spectrum is a function of the frequency in GHz (the digitizer time
+/// unit is ns), only its shape matters: the noise is normalised to the
+/// given rms (single cell amplitude units). The default is a one-pole low
+/// pass of the given bandwidth.
+
+class NoiseGenerator{
+	public:
+		NoiseGenerator(double pitch, double rms, double bandwidth = 0.2, int blockSize = 4096,
+			       int nbOfTemplates = 32, unsigned long seed = 4357);
+		~NoiseGenerator();
+
+		void SetSpectrum(std::function<double(double)> spectrum);
+		bool Load(const std::string& fileName);
+
+		inline int GetBlockSize() const {return fBlockSize;}
+		inline double GetRMS() const {return fRMS;}
+
+		// Fill GetBlockSize() samples, the template, offset and sign are
+		// taken from the bits of one random number
+		void Block(double* out, unsigned long long random) const;
+
+	private:
+		void Synthesise(std::function<double(double)> spectrum);
+
+		double fPitch, fRMS;
+		int fBlockSize, fNbOfTemplates;
+		unsigned long fSeed;
+		std::vector<double> fTemplates;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/// \file  PileupOverlay.hh
+/// \brief Definition of the PileupOverlay class
+
+#ifndef PileupOverlay_h
+#define PileupOverlay_h 1
+
+#include "CellHit.hh"
+
+#include <vector>
+#include <functional>
+#include <queue>
+#include <random>
+
+/// Beam timeline built from a library of single particle responses
+///
+/// Each response is the set of cells fired by one simulated particle, with
+/// the times relative to its gun time (the dark noise cells of the
+/// simulation are not part of it). A timeline of any length is generated
+/// by drawing the particles at Poisson arrival times and a response for
+/// each from the library, plus the dark noise of each element as an
+/// independent Poisson process on random cells. The cells are given to
+/// the output in time order, as written by order, so the timeline goes
+/// through split and digitize as a simulated run would. The eventID of the
+/// cells is the arrival number (-1 for the dark noise).
+
+class PileupOverlay{
+	public:
+		typedef std::function<void(const CellHit&)> Output;
+
+		PileupOverlay(Output output);
+		~PileupOverlay();
+
+		// One library entry, the cells of a particle (timeEv relative to
+		// the gun time), an empty response is a particle with no signal
+		void AddResponse(const std::vector<CellHit>& hits);
+		// Dark noise rate (GHz) of each element with nbOfCells cells, the
+		// elements are the ones of the library
+		void SetDarkNoise(double rate, int nbOfCells);
+
+		// Timeline of the particles arriving at rate (GHz) in [0, duration) ns
+		void Generate(double rate, double duration, std::mt19937_64& engine);
+
+		inline size_t GetNbOfResponses() const {return fEvents.size();}
+		inline long GetNbOfParticles() const {return fNbOfParticles;}
+		inline long GetNbOfHits() const {return fNbOfHits;}
+
+	private:
+		void Release(double time, std::mt19937_64& engine);
+
+		struct Cell{
+			double time;
+			int element, cell;
+		};
+		struct Later{
+			bool operator()(const CellHit& a, const CellHit& b) const {return a.time > b.time;}
+		};
+
+		Output fOutput;
+
+		// Library: provenance of each particle and its cells in fCells
+		std::vector<CellHit> fEvents;
+		std::vector<size_t> fOffsets;
+		std::vector<Cell> fCells;
+		std::vector<int> fElements;
+		double fMinTime;
+
+		// Dark noise
+		double fDNRate;
+		int fNbOfCells;
+		double fNextDN;
+
+		std::priority_queue<CellHit, std::vector<CellHit>, Later> fPending;
+		long fNbOfParticles, fNbOfHits;
+};
+
+#endif
@@ -0,0 +1,57 @@
+/// \file  PulseTemplate.hh
+/// \brief Definition of the PulseTemplate class
+
+#ifndef PulseTemplate_h
+#define PulseTemplate_h 1
+
+#include <vector>
+#include <string>
+#include <cmath>
+
+/// Single cell SiPM pulse tabulated at the digitizer pitch
+///
+/// The shape is the one of Signal() in signalsLiteNew.C: a gaussian rise up
+/// to the peak and a tail whose width grows with time,
+///   x < peak: exp(-(x - peak)^2 / 2 sigma^2)
+///   x > peak: exp(-(x - peak)^2 / 2 (sigma^2 + tail x / 2))
+///
+/// The pulse is oversampled: for each of the Oversampling sub-pitch phases
+/// of the avalanche time there is a contiguous row of samples on the
+/// digitizer grid, so that adding a pulse is a plain multiply-add over
+/// two arrays and the avalanche time is kept to pitch / Oversampling.
+
+class PulseTemplate{
+	public:
+		PulseTemplate(double pitch = 0.1, double length = 199, int oversampling = 16, 
+			      double peak = 20, double sigma = 5.94028, double tail = 39.2627);
+		~PulseTemplate();
+
+		void SetShape(double peak, double sigma, double tail);
+		bool Load(const std::string& fileName);
+
+		static double Shape(double x, double peak, double sigma, double tail);
+
+		inline double GetPitch() const {return fPitch;}
+		inline int GetSize() const {return fSize;}
+		inline int GetOversampling() const {return fOversampling;}
+
+		// Row of the pulse for an avalanche at the given time, first is the
+		// first sample of the grid not earlier than the avalanche
+		inline const double* GetPulse(double time, long& first) const {
+			long m = std::lround(time / fPitch * fOversampling);
+			first = (m >= 0) ? (m + fOversampling - 1) / fOversampling : -((-m) / fOversampling);
+			return &fData[(first * fOversampling - m) * fSize];
+		}
+
+	private:
+		void Tabulate();
+
+		double fPitch;
+		int fSize, fOversampling;
+		double fPeak, fSigma, fTail;
+		std::vector<double> fData;
+};
+
+#endif
+
+
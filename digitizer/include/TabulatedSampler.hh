@@ -0,0 +1,53 @@
+/// \file  TabulatedSampler.hh
+/// \brief Definition of the TabulatedSampler class
+
+#ifndef TabulatedSampler_h
+#define TabulatedSampler_h 1
+
+#include <vector>
+#include <functional>
+
+/// Sampler of a one dimensional distribution given by its (not normalised)
+/// density on an interval
+///
+/// The density is integrated once on a uniform grid (as TF1::GetRandom does
+/// with Npx points) and a Walker alias table is built on the bins: each
+/// sample takes one uniform number and O(1) operations, the position inside
+/// the bin is uniform. The uniform numbers are given by the caller, so the
+/// same sampler can be used with the ROOT or the Geant4 engines.
+
+class TabulatedSampler{
+	public:
+		TabulatedSampler(std::function<double(double)> density, double xMin, double xMax, int nBins = 10000);
+		~TabulatedSampler();
+
+		// u uniform in [0, 1)
+		inline double Sample(double u) const {
+			double v = u * fNbOfBins;
+			int i = int(v);
+			if(i >= fNbOfBins) i = fNbOfBins - 1;
+			double frac = v - i;
+			const Bin& bin = fBins[i];
+			if(frac < bin.prob) return fXMin + (i + frac / bin.prob) * fWidth;
+			return fXMin + (bin.alias + (frac - bin.prob) / (1 - bin.prob)) * fWidth;
+		}
+
+		// Transform n uniform numbers in place
+		void Sample(double* u, int n) const;
+
+		inline double GetMean() const {return fMean;}
+
+	private:
+		struct Bin{
+			double prob;
+			int alias;
+		};
+
+		int fNbOfBins;
+		double fXMin, fWidth, fMean;
+		std::vector<Bin> fBins;
+};
+
+#endif
+
+
@@ -0,0 +1,47 @@
+/// \file  TaskPool.hh
+/// \brief Definition of the TaskPool class
+
+#ifndef TaskPool_h
+#define TaskPool_h 1
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <memory>
+
+/// Work-stealing pool of threads for independent tasks of uneven length
+///
+/// The tasks are dealt round-robin to the worker queues in the given order
+/// (so the longest should come first); a worker takes from the front of its
+/// own queue and, once empty, steals from the back of the others. The task
+/// receives the worker number, to use per-worker state without locks.
+
+class TaskPool{
+	public:
+		typedef std::function<void(int worker)> Task;
+
+		TaskPool(int nThreads = 0); // 0: hardware concurrency
+		~TaskPool();
+
+		inline int GetNbOfThreads() const {return fNbOfThreads;}
+
+		// Returns when all the tasks are done
+		void Run(std::vector<Task>& tasks);
+
+	private:
+		struct Queue{
+			std::mutex mutex;
+			std::deque<Task*> tasks;
+		};
+
+		void Work(int worker);
+		Task* Pop(int worker);
+
+		int fNbOfThreads;
+		std::vector<std::unique_ptr<Queue>> fQueues;
+};
+
+#endif
+
+
@@ -0,0 +1,50 @@
+/// \file  ThresholdScan.hh
+/// \brief Definition of the ThresholdScan class
+
+#ifndef ThresholdScan_h
+#define ThresholdScan_h 1
+
+#include <vector>
+
+/// Counts above threshold per channel for many thresholds at once
+///
+/// The values are binned per channel on a uniform grid from 0 to max (the
+/// values above max go to the last bin, the negative ones are dropped); the
+/// number of values at or above the lower edge of each bin is then the
+/// reverse cumulative sum. Thresholds on the bin edges are exact, so one
+/// pass replaces one reprocess() per threshold. Partial scans filled by
+/// different threads are combined with Add().
+
+class ThresholdScan{
+	public:
+		ThresholdScan(int nBins = 1000, double max = 50);
+		~ThresholdScan();
+
+		inline void Fill(int channel, double value){
+			if(value < 0 || channel < 0) return;
+			if(channel >= fNbOfChannels) Resize(channel + 1);
+			int bin = int(value / fWidth);
+			if(bin >= fNbOfBins) bin = fNbOfBins - 1;
+			fCounts[size_t(channel) * fNbOfBins + bin]++;
+		}
+
+		void Add(const ThresholdScan& other);
+
+		// Element j: number of values >= j * binWidth
+		std::vector<long> GetCounts(int channel) const;
+
+		inline int GetNbOfChannels() const {return fNbOfChannels;}
+		inline int GetNbOfBins() const {return fNbOfBins;}
+		inline double GetBinWidth() const {return fWidth;}
+
+	private:
+		void Resize(int nChannels);
+
+		int fNbOfBins, fNbOfChannels;
+		double fWidth;
+		std::vector<long> fCounts; // [channel][bin]
+};
+
+#endif
+
+
@@ -0,0 +1,29 @@
+/// \file  WaveSnippet.hh
+/// \brief Definition of the WaveSnippet record
+
+#ifndef WaveSnippet_h
+#define WaveSnippet_h 1
+
+#include <vector>
+
+/// Piece of waveform around one or more threshold crossings
+///
+/// The samples are ADC counts (value / lsb rounded), stored as the
+/// differences between consecutive samples in zig-zag varint bytes: the
+/// flat parts of the pulse take one byte per sample.
+
+struct WaveSnippet{
+	int channel = 0;
+	int eventID = 0;   // of the first signal in the snippet
+	double time = 0;   // ns, first sample
+	double pitch = 0;  // ns
+	double lsb = 0;    // amplitude of one ADC count
+	std::vector<unsigned char> data;
+
+	static void Encode(const std::vector<int>& adc, std::vector<unsigned char>& data);
+	static void Decode(const std::vector<unsigned char>& data, std::vector<int>& adc);
+};
+
+#endif
+
+
@@ -0,0 +1,131 @@
+/// \file  WaveformDigitizer.hh
+/// \brief Definition of the WaveformDigitizer class
+
+#ifndef WaveformDigitizer_h
+#define WaveformDigitizer_h 1
+
+#include "CellHit.hh"
+#include "PulseTemplate.hh"
+#include "WaveSnippet.hh"
+#include "NoiseGenerator.hh"
+
+#include <vector>
+#include <random>
+
+/// Streaming waveform digitizer of one readout channel
+///
+/// The time-ordered cell hits are added to a ring buffer by overlap-add of
+/// the pulse template; the samples are finalized as time advances past them
+/// and discriminated on the fly. Stretches without pending pulses are
+/// skipped. Each signal has the same content as an entry of the waves tree
+/// written by processing() in signalsLiteNew.C:
+///  - Time: first sample above threshold
+///  - Charge: sum of the samples up to the first one below threshold
+///    (at most Window after the crossing) times pitch / ChargeNorm
+///  - Amplitude: maximum over the time over threshold
+///  - DeltaTime: previous signal time minus this one (the first signal of
+///    the channel is referred to 0), as in the macro
+///  - provenance: information of the last hit added before the crossing
+///  - TimeLE: threshold crossing interpolated between the samples
+///  - TimeCFD: crossing of a fraction (CFDFraction) of the amplitude on the
+///    rising edge, interpolated (it may be before the threshold crossing)
+///  - ToT: from TimeLE to the interpolated crossing back below threshold
+///    (up to Window for the signals cut at the window)
+/// The timing is computed in the same pass from a short history of the
+/// finalized samples.
+///
+/// With a NoiseGenerator the baseline noise is added to the smeared
+/// waveform as the samples are finalized, one block at a time. The skipped
+/// stretches stay skipped: the noise alone is assumed not to cross the
+/// threshold.
+///
+/// Optionally the waveform around the crossings is kept as snippets, from
+/// pre samples before the crossing to post samples after the last sample
+/// above threshold (overlapping snippets are merged).
+
+class WaveformDigitizer{
+	public:
+		WaveformDigitizer(const PulseTemplate* pulse, double threshold, double window = 200);
+		~WaveformDigitizer();
+
+		void SetChannel(int channel){fChannel = channel;}
+		void SetChargeNorm(double val){fChargeNorm = val;}
+		void SetCFDFraction(double val){fCFDFraction = val;}
+		void SetSnapshot(int pre, int post, double lsb);
+		// The noise is drawn only for the samples processed: the idle
+		// stretches are skipped, so it depends on the seed and on the hits
+		void SetNoise(const NoiseGenerator* noise){fNoise = noise;}
+		void SetNoiseSeed(unsigned long seed);
+
+		void AddHit(const CellHit& hit, double smearing);
+		// Finalize the samples before time, no later hit may come earlier
+		// (it would be moved to time and counted in GetNbOfLateHits())
+		void AdvanceTo(double time);
+		void Flush();
+
+		inline std::vector<WaveSignal>& GetSignals(){return fSignals;}
+		inline std::vector<WaveSnippet>& GetSnippets(){return fSnippets;}
+		inline long GetNbOfLateHits() const {return fNbOfLateHits;}
+
+	private:
+		void Advance(long sample);
+		void ProcessSample(long k);
+		void Discriminate(long k, double v, double vNoSmearing);
+		void Finalize();
+		void Capture(long k, double v, bool trigger);
+		void CloseCapture();
+		void ResizeHistory(long n);
+		inline double History(long i) const {
+			return (i >= 0 && fHistoryIndex[i & fHistoryMask] == i) ? fHistory[i & fHistoryMask] : 0;
+		}
+
+		const PulseTemplate* fPulse;
+		double fThreshold;
+		double fPitch;
+		int fWindow;
+		double fChargeNorm;
+		int fChannel;
+
+		// Ring buffers of the smeared and not smeared waveforms
+		std::vector<double> fRing, fRingNoSmearing;
+		long fMask;
+		long fNext; // first sample not finalized yet
+		long fEnd;  // one past the last sample reached by the pending pulses
+		long fNbOfLateHits;
+
+		// Discriminator
+		enum State {kIdle, kActive, kWaitBelow};
+		State fState;
+		long fStart;
+		double fPrevTime;
+		double fCFDFraction;
+		long fPeak;
+		WaveSignal fCurrent;
+		CellHit fLastHit;
+
+		std::vector<WaveSignal> fSignals;
+
+		// Baseline noise
+		const NoiseGenerator* fNoise;
+		std::mt19937_64 fNoiseEngine;
+		std::vector<double> fNoiseBlock;
+		int fNoiseIndex;
+
+		// Last finalized samples, for the timing and the snapshots
+		std::vector<double> fHistory;
+		std::vector<long> fHistoryIndex;
+		long fHistoryMask;
+
+		// Snapshots
+		int fSnapPre, fSnapPost; // fSnapPre < 0: disabled
+		double fLSB;
+		bool fCapturing;
+		long fCaptureEnd;
+		std::vector<int> fCapture;
+		WaveSnippet fSnippet;
+		std::vector<WaveSnippet> fSnippets;
+};
+
+#endif
+
+
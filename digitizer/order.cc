@@ -0,0 +1,82 @@
+/// \file order.cc
+/// \brief Compiled replacement of ordering() in signalsLiteNew.C
+///
+/// Usage: order [-n] [-b bufferSize] [-T tmpDir] data.root file
+/// Writes to file.root the tree T with all the fired cells of data.root in
+/// strict time order. With -n the dark noise cells are dropped. The memory
+/// is bounded by the buffer (in hits), larger inputs are merged from
+/// temporary sorted runs.
+
+#include "HitSorter.hh"
+#include "DigitizerIO.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+#include <unistd.h>
+
+int main(int argc, char** argv){
+	bool darkNoise = true;
+	size_t bufferSize = 1 << 22;
+	std::string tmpDir;
+
+	int opt;
+	while((opt = getopt(argc, argv, "nb:T:")) != -1){
+		switch(opt){
+			case 'n': darkNoise = false; break;
+			case 'b': bufferSize = std::strtoul(optarg, nullptr, 10); break;
+			case 'T': tmpDir = optarg; break;
+			default:
+				std::cerr << "Usage: " << argv[0] << " [-n] [-b bufferSize] [-T tmpDir] data.root file" << std::endl;
+				return 1;
+		}
+	}
+	if(optind + 2 > argc){
+		std::cerr << "Usage: " << argv[0] << " [-n] [-b bufferSize] [-T tmpDir] data.root file" << std::endl;
+		return 1;
+	}
+	std::string name = argv[optind];
+	std::string file = argv[optind + 1];
+
+	TFile* F = TFile::Open(name.c_str());
+	if(!F || F->IsZombie()){
+		std::cerr << "Cannot open " << name << std::endl;
+		return 1;
+	}
+	TTree* T = (TTree*) F->Get("T");
+	if(!T){
+		std::cerr << "No tree T in " << name << std::endl;
+		return 1;
+	}
+
+	HitSorter sorter(bufferSize, tmpDir);
+	try{
+		EventReader reader(T);
+		long N = reader.GetEntries();
+		for(long i = 0; i < N; i++){
+			for(auto& hit : reader.Get(i, darkNoise)) sorter.Add(hit);
+		}
+	}
+	catch(const std::runtime_error& error){
+		std::cerr << name << ": " << error.what() << std::endl;
+		return 1;
+	}
+	std::cout << sorter.GetNbOfHits() << " hits in " << sorter.GetNbOfRuns() << " runs" << std::endl;
+
+	TFile* N = TFile::Open((file + ".root").c_str(), "RECREATE");
+	TTree* Tnew = new TTree("T", "signals");
+	HitWriter writer(Tnew);
+	sorter.Merge([&writer](const CellHit& hit){writer.Fill(hit);});
+
+	N->cd();
+	Tnew->Write("T", TObject::kOverwrite);
+	N->Close();
+	F->Close();
+	return 0;
+}
+
+
@@ -0,0 +1,92 @@
+/// \file overlay.cc
+/// \brief Beam timeline from a library of simulated particles
+///
+/// Usage: overlay [-R rate] [-t duration] [-d DNrate] [-c cells] [-r seed] data.root file
+/// The fired cells of each event of data.root (the dark noise cells
+/// excepted) are one entry of the library. Writes to file.root the tree T
+/// of the cells of the particles arriving at rate (MHz, default 1900) for
+/// duration (us, default 1000) in strict time order, as written by order,
+/// with the dark noise (kHz per element, default 90, on cells cells,
+/// default 285). The timeline goes through split and digitize as the
+/// simulated runs do, so the beam rate is scanned without running Geant4
+/// again.
+
+#include "PileupOverlay.hh"
+#include "DigitizerIO.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+	const char* kUsage = " [-R rate] [-t duration] [-d DNrate] [-c cells] [-r seed] data.root file";
+}
+
+int main(int argc, char** argv){
+	double rate = 1900, duration = 1000, DNrate = 90;
+	int nbOfCells = 285;
+	unsigned long seed = 4357;
+
+	int opt;
+	while((opt = getopt(argc, argv, "R:t:d:c:r:")) != -1){
+		switch(opt){
+			case 'R': rate = std::atof(optarg); break;
+			case 't': duration = std::atof(optarg); break;
+			case 'd': DNrate = std::atof(optarg); break;
+			case 'c': nbOfCells = std::atoi(optarg); break;
+			case 'r': seed = std::strtoul(optarg, nullptr, 10); break;
+			default:
+				std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+				return 1;
+		}
+	}
+	if(optind + 2 > argc){
+		std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+		return 1;
+	}
+	std::string name = argv[optind];
+	std::string file = argv[optind + 1];
+
+	TFile* F = TFile::Open(name.c_str());
+	if(!F || F->IsZombie()){
+		std::cerr << "Cannot open " << name << std::endl;
+		return 1;
+	}
+	TTree* T = (TTree*) F->Get("T");
+	if(!T){
+		std::cerr << "No tree T in " << name << std::endl;
+		return 1;
+	}
+
+	TFile* N = TFile::Open((file + ".root").c_str(), "RECREATE");
+	TTree* Tnew = new TTree("T", "signals");
+	HitWriter writer(Tnew);
+	PileupOverlay overlay([&writer](const CellHit& hit){writer.Fill(hit);});
+	try{
+		EventReader reader(T);
+		long nEvents = reader.GetEntries();
+		for(long i = 0; i < nEvents; i++) overlay.AddResponse(reader.Get(i, false));
+	}
+	catch(const std::runtime_error& error){
+		std::cerr << name << ": " << error.what() << std::endl;
+		return 1;
+	}
+	// ns and GHz
+	overlay.SetDarkNoise(DNrate * 1e-6, nbOfCells);
+	std::mt19937_64 engine(seed);
+	overlay.Generate(rate * 1e-3, duration * 1e3, engine);
+	std::cout << overlay.GetNbOfParticles() << " particles from " << overlay.GetNbOfResponses()
+		  << " responses, " << overlay.GetNbOfHits() << " hits" << std::endl;
+
+	N->cd();
+	Tnew->Write("T", TObject::kOverwrite);
+	N->Close();
+	F->Close();
+	return 0;
+}
@@ -0,0 +1,166 @@
+/// \file scan.cc
+/// \brief Threshold scan of the waves tree, replaces the reprocess*() of
+/// signalsLiteNew.C
+///
+/// Usage: scan [-b bins] [-a maxAmplitude] [-q maxCharge] [-s SurfIn] [-d DNmin]
+///             [-j threads] file
+/// Reads the waves tree of file.root once, in parallel, and writes to
+/// file_scan.root the number of signals at or above threshold versus
+/// threshold for every channel, for the amplitude and for the charge
+/// (TH2D channel x threshold, ProjectionY gives the curve of a channel),
+/// and the time span of the signals in s (TParameter LiveTime).
+/// Optional cuts: SurfIn == value (as reprocessOneSide), DN > DNmin (as
+/// reprocessDN).
+
+#include "ThresholdScan.hh"
+#include "TaskPool.hh"
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TH2D.h"
+#include "TParameter.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+	const char* kUsage = " [-b bins] [-a maxAmplitude] [-q maxCharge] [-s SurfIn] [-d DNmin] [-j threads] file";
+
+	// State of one worker thread
+	struct Worker{
+		TFile* file = nullptr;
+		TTree* tree = nullptr;
+		int channel = 0, DN = 0, surfIn = 0;
+		double amplitude = 0, charge = 0, time = 0;
+		double tMin = std::numeric_limits<double>::max();
+		double tMax = std::numeric_limits<double>::lowest();
+		std::unique_ptr<ThresholdScan> amplitudeScan, chargeScan;
+	};
+
+	TH2D* MakeHistogram(const char* name, const char* title, const ThresholdScan& scan){
+		int nChannels = std::max(scan.GetNbOfChannels(), 1);
+		int nBins = scan.GetNbOfBins();
+		TH2D* h = new TH2D(name, title, nChannels, -0.5, nChannels - 0.5, 
+				   nBins, -0.5 * scan.GetBinWidth(), (nBins - 0.5) * scan.GetBinWidth());
+		h->SetXTitle("Channel");
+		h->SetYTitle("Threshold");
+		for(int c = 0; c < scan.GetNbOfChannels(); c++){
+			std::vector<long> counts = scan.GetCounts(c);
+			for(int j = 0; j < nBins; j++) h->SetBinContent(c + 1, j + 1, counts[j]);
+		}
+		h->SetEntries(h->Integral());
+		return h;
+	}
+}
+
+int main(int argc, char** argv){
+	int nBins = 1000;
+	double maxAmplitude = 50, maxCharge = 50;
+	bool cutSurfIn = false, cutDN = false;
+	int surfIn = 0;
+	double DNmin = 0;
+	int nThreads = 0;
+
+	int opt;
+	while((opt = getopt(argc, argv, "b:a:q:s:d:j:")) != -1){
+		switch(opt){
+			case 'b': nBins = std::atoi(optarg); break;
+			case 'a': maxAmplitude = std::atof(optarg); break;
+			case 'q': maxCharge = std::atof(optarg); break;
+			case 's': cutSurfIn = true; surfIn = std::atoi(optarg); break;
+			case 'd': cutDN = true; DNmin = std::atof(optarg); break;
+			case 'j': nThreads = std::atoi(optarg); break;
+			default:
+				std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+				return 1;
+		}
+	}
+	if(optind >= argc){
+		std::cerr << "Usage: " << argv[0] << kUsage << std::endl;
+		return 1;
+	}
+	std::string name = argv[optind];
+	std::string file = name + ".root";
+
+	ROOT::EnableThreadSafety();
+
+	long nEntries = 0;
+	{
+		std::unique_ptr<TFile> F(TFile::Open(file.c_str()));
+		TTree* T = F && !F->IsZombie() ? (TTree*) F->Get("waves") : nullptr;
+		if(!T){
+			std::cerr << "No waves tree in " << file << std::endl;
+			return 1;
+		}
+		nEntries = T->GetEntries();
+	}
+
+	TaskPool pool(nThreads);
+	std::vector<Worker> workers(pool.GetNbOfThreads());
+
+	// a few chunks per thread, contiguous entries read only the needed branches
+	long nChunks = std::min<long>(4 * pool.GetNbOfThreads(), std::max<long>(nEntries, 1));
+	std::vector<TaskPool::Task> tasks;
+	for(long k = 0; k < nChunks; k++){
+		long first = nEntries * k / nChunks, last = nEntries * (k + 1) / nChunks;
+		tasks.push_back([&, first, last](int w){
+			Worker& worker = workers[w];
+			if(!worker.file){
+				worker.file = TFile::Open(file.c_str());
+				worker.tree = (TTree*) worker.file->Get("waves");
+				worker.tree->SetBranchStatus("*", 0);
+				const char* branches[] = {"Channel", "Amplitude", "Charge", "Time", "DN", "SurfIn"};
+				for(const char* branch : branches) worker.tree->SetBranchStatus(branch, 1);
+				worker.tree->SetBranchAddress("Channel", &worker.channel);
+				worker.tree->SetBranchAddress("Amplitude", &worker.amplitude);
+				worker.tree->SetBranchAddress("Charge", &worker.charge);
+				worker.tree->SetBranchAddress("Time", &worker.time);
+				worker.tree->SetBranchAddress("DN", &worker.DN);
+				worker.tree->SetBranchAddress("SurfIn", &worker.surfIn);
+				worker.amplitudeScan.reset(new ThresholdScan(nBins, maxAmplitude));
+				worker.chargeScan.reset(new ThresholdScan(nBins, maxCharge));
+			}
+			for(long i = first; i < last; i++){
+				worker.tree->GetEntry(i);
+				worker.tMin = std::min(worker.tMin, worker.time);
+				worker.tMax = std::max(worker.tMax, worker.time);
+				if(cutSurfIn && worker.surfIn != surfIn) continue;
+				if(cutDN && !(worker.DN > DNmin)) continue;
+				worker.amplitudeScan->Fill(worker.channel, worker.amplitude);
+				worker.chargeScan->Fill(worker.channel, worker.charge);
+			}
+		});
+	}
+	pool.Run(tasks);
+
+	ThresholdScan amplitudeScan(nBins, maxAmplitude), chargeScan(nBins, maxCharge);
+	double tMin = std::numeric_limits<double>::max(), tMax = std::numeric_limits<double>::lowest();
+	for(auto& worker : workers){
+		if(!worker.file) continue;
+		amplitudeScan.Add(*worker.amplitudeScan);
+		chargeScan.Add(*worker.chargeScan);
+		tMin = std::min(tMin, worker.tMin);
+		tMax = std::max(tMax, worker.tMax);
+		delete worker.file;
+	}
+
+	TFile* N = TFile::Open((name + "_scan.root").c_str(), "RECREATE");
+	MakeHistogram("AmplitudeScan", "Signals with Amplitude >= threshold", amplitudeScan)->Write();
+	MakeHistogram("ChargeScan", "Signals with Charge >= threshold", chargeScan)->Write();
+	TParameter<double> liveTime("LiveTime", nEntries > 0 ? (tMax - tMin) / 1e9 : 0);
+	liveTime.Write();
+	N->Close();
+
+	std::cout << nEntries << " signals on " << amplitudeScan.GetNbOfChannels() << " channels, " 
+		  << nBins << " thresholds written to " << name << "_scan.root" << std::endl;
+	return 0;
+}
+
+
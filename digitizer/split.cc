@@ -0,0 +1,70 @@
+/// \file split.cc
+/// \brief Compiled replacement of preprocessing() in signalsLiteNew.C
+///
+/// Usage: split [-m channel_map.txt] [-d deadTime] file
+/// Reads the time ordered tree T of file.root written by order and adds to
+/// the same file one tree ChNN per readout channel, in one pass. The cells
+/// that fired less than deadTime (ns, default 20) before are dropped.
+
+#include "ChannelMap.hh"
+#include "ChannelSplitter.hh"
+#include "DigitizerIO.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <unistd.h>
+
+int main(int argc, char** argv){
+	std::string mapFile;
+	double deadTime = 20;
+
+	int opt;
+	while((opt = getopt(argc, argv, "m:d:")) != -1){
+		switch(opt){
+			case 'm': mapFile = optarg; break;
+			case 'd': deadTime = std::atof(optarg); break;
+			default:
+				std::cerr << "Usage: " << argv[0] << " [-m channel_map.txt] [-d deadTime] file" << std::endl;
+				return 1;
+		}
+	}
+	if(optind >= argc){
+		std::cerr << "Usage: " << argv[0] << " [-m channel_map.txt] [-d deadTime] file" << std::endl;
+		return 1;
+	}
+	std::string file = argv[optind];
+
+	ChannelMap map;
+	if(!mapFile.empty() && !map.Load(mapFile)) return 1;
+
+	TFile* F = TFile::Open((file + ".root").c_str(), "UPDATE");
+	if(!F || F->IsZombie()){
+		std::cerr << "Cannot open " << file << ".root" << std::endl;
+		return 1;
+	}
+	TTree* T = (TTree*) F->Get("T");
+	if(!T){
+		std::cerr << "No tree T in " << file << ".root" << std::endl;
+		return 1;
+	}
+
+	ChannelWriter writer(F);
+	ChannelSplitter splitter(&map, [&writer](int channel, const CellHit& hit){writer.Fill(channel, hit);}, deadTime);
+	{
+		HitReader reader(T);
+		long N = reader.GetEntries();
+		for(long i = 0; i < N; i++) splitter.Add(reader.Get(i));
+	}
+	int nChannels = writer.Write();
+	std::cout << splitter.GetNbOfAccepted() << " hits on " << nChannels << " channels, " 
+		  << splitter.GetNbOfDead() << " in dead time, " << splitter.GetNbOfUnmapped() << " not mapped" << std::endl;
+
+	F->Close();
+	return 0;
+}
+
+
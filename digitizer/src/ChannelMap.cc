@@ -0,0 +1,86 @@
+/// \file  ChannelMap.cc
+/// \brief Implementation of the ChannelMap class
+
+#include "ChannelMap.hh"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <climits>
+
+ChannelMap::ChannelMap(){}
+
+ChannelMap::~ChannelMap(){}
+
+bool ChannelMap::Load(const std::string& fileName){
+	std::ifstream myfile(fileName);
+	if(!myfile.is_open()){
+		std::cerr << "ChannelMap: cannot open " << fileName << std::endl;
+		return false;
+	}
+	fRanges.clear();
+	std::string line;
+	while(std::getline(myfile, line)){
+		if(line.empty() || line[0] == '#') continue;
+		std::istringstream is(line);
+		Range range;
+		if(!(is >> range.element >> range.first >> range.last >> range.channel)){
+			std::cerr << "ChannelMap: skipping malformed line: " << line << std::endl;
+			continue;
+		}
+		if(range.last < 0) range.last = INT_MAX;
+		fRanges.push_back(range);
+	}
+	std::sort(fRanges.begin(), fRanges.end(), [](const Range& a, const Range& b){
+		return a.element < b.element || (a.element == b.element && a.first < b.first);
+	});
+
+	// Dense cell index inside each channel: the closed ranges first, then the
+	// (at most one) open ended range of the channel
+	std::map<int, int> size, open;
+	for(size_t i = 0; i < fRanges.size(); i++){
+		Range& range = fRanges[i];
+		if(i > 0 && range.element == fRanges[i - 1].element && range.first <= fRanges[i - 1].last){
+			std::cerr << "ChannelMap: overlapping ranges for element " << range.element << std::endl;
+			fRanges.clear();
+			return false;
+		}
+		if(range.last == INT_MAX){
+			if(open[range.channel]++ > 0){
+				std::cerr << "ChannelMap: more than one open range for channel " << range.channel << std::endl;
+				fRanges.clear();
+				return false;
+			}
+			continue;
+		}
+		range.offset = size[range.channel];
+		size[range.channel] += range.last - range.first + 1;
+	}
+	for(auto& range : fRanges) if(range.last == INT_MAX) range.offset = size[range.channel];
+	size.insert(open.begin(), open.end());
+	std::cout << "ChannelMap: " << fRanges.size() << " ranges on " << size.size() << " channels from " << fileName << std::endl;
+	return true;
+}
+
+bool ChannelMap::Map(int element, int cell, int& channel, int& index) const {
+	if(fRanges.empty()){
+		channel = element;
+		index = cell;
+		return true;
+	}
+	// last range starting at or before the cell
+	auto it = std::upper_bound(fRanges.begin(), fRanges.end(), std::make_pair(element, cell), 
+		[](const std::pair<int, int>& key, const Range& r){
+			return key.first < r.element || (key.first == r.element && key.second < r.first);
+		});
+	if(it == fRanges.begin()) return false;
+	--it;
+	if(it->element != element || cell > it->last) return false;
+	channel = it->channel;
+	index = it->offset + cell - it->first;
+	return true;
+}
+
+
@@ -0,0 +1,31 @@
+/// \file  ChannelSplitter.cc
+/// \brief Implementation of the ChannelSplitter class
+
+#include "ChannelSplitter.hh"
+
+#include <limits>
+
+ChannelSplitter::ChannelSplitter(const ChannelMap* map, Output output, double deadTime) : 
+	fMap(map), fOutput(output), fDeadTime(deadTime), fAccepted(0), fDead(0), fUnmapped(0){}
+
+ChannelSplitter::~ChannelSplitter(){}
+
+void ChannelSplitter::Add(const CellHit& hit){
+	int channel, index;
+	if(!fMap->Map(hit.element, hit.cell, channel, index) || channel < 0 || index < 0){
+		fUnmapped++;
+		return;
+	}
+	if(channel >= int(fLastTime.size())) fLastTime.resize(channel + 1);
+	std::vector<double>& last = fLastTime[channel];
+	if(index >= int(last.size())) last.resize(index + 1, -std::numeric_limits<double>::infinity());
+
+	if(hit.time - last[index] > fDeadTime){
+		last[index] = hit.time;
+		fAccepted++;
+		fOutput(channel, hit);
+	}
+	else fDead++;
+}
+
+
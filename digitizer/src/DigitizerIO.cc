@@ -0,0 +1,218 @@
+/// \file  DigitizerIO.cc
+/// \brief Implementation of the ROOT readers and writers of the digitizer
+
+#include "DigitizerIO.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+	// Some branches are missing in older files, they are left to 0
+	template<typename T> void Bind(TTree* tree, const char* name, T* address){
+		if(tree->GetBranch(name)) tree->SetBranchAddress(name, address);
+	}
+}
+
+EventReader::EventReader(TTree* tree) : 
+	fTree(tree), fCells(0), fDNflag(0), fCellTime(0), fGunTime(0){
+	// not written by the saturation-only response nor by the in-simulation digitizer
+	if(!fTree->GetBranch("Cells") || !fTree->GetBranch("CellTime")){
+		throw std::runtime_error("EventReader: no Cells/CellTime branches in the tree (SiPMResponse saturation or Digitize run?)");
+	}
+	fTree->SetBranchAddress("Cells", &fCells);
+	fTree->SetBranchAddress("CellTime", &fCellTime);
+	Bind(fTree, "DNflag", &fDNflag);
+	Bind(fTree, "GunTime", &fGunTime);
+	Bind(fTree, "TrackLength", &fEvent.trackLength);
+	Bind(fTree, "ThetaIn", &fEvent.thetaIn);
+	Bind(fTree, "SecondaryID", &fEvent.secondaryID);
+	Bind(fTree, "bounce", &fEvent.bounce);
+	Bind(fTree, "eventID", &fEvent.eventID);
+	Bind(fTree, "SurfIn", &fEvent.surfIn);
+	Bind(fTree, "Element", &fEvent.element);
+}
+
+EventReader::~EventReader(){
+	fTree->ResetBranchAddresses();
+	delete fCells;
+	delete fDNflag;
+	delete fCellTime;
+}
+
+long EventReader::GetEntries(){
+	return fTree->GetEntries();
+}
+
+const std::vector<CellHit>& EventReader::Get(long i, bool darkNoise){
+	fTree->GetEntry(i);
+	fHits.clear();
+	CellHit hit = fEvent;
+	for(size_t j = 0; j < fCells->size(); j++){
+		hit.DN = fDNflag ? fDNflag->at(j) : 0;
+		if(!darkNoise && hit.DN != 0) continue;
+		hit.cell = fCells->at(j);
+		hit.time = fCellTime->at(j);
+		hit.timeEv = hit.time - fGunTime;
+		fHits.push_back(hit);
+	}
+	return fHits;
+}
+
+HitWriter::HitWriter(TTree* tree) : fTree(tree){
+	fTree->Branch("Element", &fHit.element);
+	fTree->Branch("Cells", &fHit.cell);
+	fTree->Branch("DNflag", &fHit.DN);
+	fTree->Branch("CellTime", &fHit.time);
+	fTree->Branch("CellTimeEv", &fHit.timeEv);
+	fTree->Branch("TrackLength", &fHit.trackLength);
+	fTree->Branch("ThetaIn", &fHit.thetaIn);
+	fTree->Branch("SecondaryID", &fHit.secondaryID);
+	fTree->Branch("Bounce", &fHit.bounce);
+	fTree->Branch("eventID", &fHit.eventID);
+	fTree->Branch("SurfIn", &fHit.surfIn);
+}
+
+HitWriter::~HitWriter(){}
+
+void HitWriter::Fill(const CellHit& hit){
+	fHit = hit;
+	fTree->Fill();
+}
+
+/// Both the ordered tree T and the ChNN trees
+HitReader::HitReader(TTree* tree) : fTree(tree){
+	bool ordered = fTree->GetBranch("CellTime");
+	fTree->SetBranchAddress(ordered ? "Cells" : "Cell", &fHit.cell);
+	fTree->SetBranchAddress(ordered ? "CellTime" : "Time", &fHit.time);
+	fTree->SetBranchAddress(ordered ? "CellTimeEv" : "TimeEv", &fHit.timeEv);
+	fTree->SetBranchAddress("DNflag", &fHit.DN);
+	fTree->SetBranchAddress("TrackLength", &fHit.trackLength);
+	fTree->SetBranchAddress("ThetaIn", &fHit.thetaIn);
+	fTree->SetBranchAddress("SecondaryID", &fHit.secondaryID);
+	fTree->SetBranchAddress("Bounce", &fHit.bounce);
+	fTree->SetBranchAddress("eventID", &fHit.eventID);
+	fTree->SetBranchAddress("SurfIn", &fHit.surfIn);
+	Bind(fTree, "Element", &fHit.element);
+}
+
+HitReader::~HitReader(){
+	fTree->ResetBranchAddresses();
+}
+
+long HitReader::GetEntries(){
+	return fTree->GetEntries();
+}
+
+const CellHit& HitReader::Get(long i){
+	fTree->GetEntry(i);
+	return fHit;
+}
+
+ChannelWriter::ChannelWriter(TFile* file) : fFile(file){}
+
+ChannelWriter::~ChannelWriter(){}
+
+/// The tree of a channel is created at its first hit
+void ChannelWriter::Fill(int channel, const CellHit& hit){
+	if(channel >= int(fTrees.size())) fTrees.resize(channel + 1, nullptr);
+	TTree*& tree = fTrees[channel];
+	if(!tree){
+		fFile->cd();
+		TString name = TString::Format("Ch%02d", channel);
+		tree = new TTree(name, name);
+		tree->Branch("Cell", &fHit.cell);
+		tree->Branch("DNflag", &fHit.DN);
+		tree->Branch("Time", &fHit.time);
+		tree->Branch("TimeEv", &fHit.timeEv);
+		tree->Branch("TrackLength", &fHit.trackLength);
+		tree->Branch("ThetaIn", &fHit.thetaIn);
+		tree->Branch("SecondaryID", &fHit.secondaryID);
+		tree->Branch("Bounce", &fHit.bounce);
+		tree->Branch("eventID", &fHit.eventID);
+		tree->Branch("SurfIn", &fHit.surfIn);
+		// with many channels the default baskets would take most of the
+		// memory, ROOT resizes them at the first flush
+		tree->SetBasketSize("*", 4096);
+	}
+	fHit = hit;
+	tree->Fill();
+}
+
+int ChannelWriter::Write(){
+	fFile->cd();
+	int n = 0;
+	for(TTree* tree : fTrees){
+		if(!tree) continue;
+		tree->Write(tree->GetName(), TObject::kOverwrite);
+		n++;
+	}
+	return n;
+}
+
+WaveWriter::WaveWriter(TTree* tree) : fTree(tree){
+	fTree->Branch("Channel", &fSignal.channel);
+	fTree->Branch("DN", &fSignal.DN);
+	fTree->Branch("Amplitude", &fSignal.amplitude);
+	fTree->Branch("AmplitudeNoSmearing", &fSignal.amplitudeNoSmearing);
+	fTree->Branch("Charge", &fSignal.charge);
+	fTree->Branch("ChargeNoSmearing", &fSignal.chargeNoSmearing);
+	fTree->Branch("Time", &fSignal.time);
+	fTree->Branch("TimeEv", &fSignal.timeEv);
+	fTree->Branch("DeltaTime", &fSignal.deltaTime);
+	fTree->Branch("TimeLE", &fSignal.timeLE);
+	fTree->Branch("TimeCFD", &fSignal.timeCFD);
+	fTree->Branch("ToT", &fSignal.timeOverThreshold);
+	fTree->Branch("TrackLength", &fSignal.trackLength);
+	fTree->Branch("ThetaIn", &fSignal.thetaIn);
+	fTree->Branch("SecondaryID", &fSignal.secondaryID);
+	fTree->Branch("Bounce", &fSignal.bounce);
+	fTree->Branch("eventID", &fSignal.eventID);
+	fTree->Branch("SurfIn", &fSignal.surfIn);
+}
+
+WaveWriter::~WaveWriter(){}
+
+void WaveWriter::Fill(const WaveSignal& signal){
+	fSignal = signal;
+	fTree->Fill();
+}
+
+SnippetWriter::SnippetWriter(TTree* tree) : fTree(tree){
+	fTree->Branch("Channel", &fSnippet.channel);
+	fTree->Branch("eventID", &fSnippet.eventID);
+	fTree->Branch("Time", &fSnippet.time);
+	fTree->Branch("Pitch", &fSnippet.pitch);
+	fTree->Branch("LSB", &fSnippet.lsb);
+	fTree->Branch("Data", &fSnippet.data);
+}
+
+SnippetWriter::~SnippetWriter(){}
+
+void SnippetWriter::Fill(const WaveSnippet& snippet){
+	fSnippet = snippet;
+	fTree->Fill();
+}
+
+std::vector<std::pair<int, std::string>> GetChannelTrees(TFile* file){
+	std::vector<std::pair<int, std::string>> channels;
+	TIter next(file->GetListOfKeys());
+	while(TKey* key = (TKey*) next()){
+		std::string name = key->GetName();
+		if(std::string(key->GetClassName()) != "TTree" || name.size() < 3 || name.compare(0, 2, "Ch") != 0) continue;
+		if(!std::all_of(name.begin() + 2, name.end(), [](char c){return std::isdigit(c);})) continue;
+		channels.push_back(std::make_pair(std::atoi(name.c_str() + 2), name));
+	}
+	std::sort(channels.begin(), channels.end());
+	channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+	return channels;
+}
+
+
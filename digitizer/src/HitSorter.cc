@@ -0,0 +1,129 @@
+/// \file  HitSorter.cc
+/// \brief Implementation of the HitSorter class
+
+#include "HitSorter.hh"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+	const size_t kReadBlock = 4096;
+
+	inline bool Earlier(const CellHit& a, const CellHit& b){return a.time < b.time;}
+
+	// Sequential reader of one run
+	struct Run{
+		FILE* file;
+		std::vector<CellHit> block;
+		size_t pos;
+
+		bool Next(){
+			if(++pos < block.size()) return true;
+			block.resize(kReadBlock);
+			block.resize(fread(block.data(), sizeof(CellHit), kReadBlock, file));
+			pos = 0;
+			return !block.empty();
+		}
+	};
+}
+
+HitSorter::HitSorter(size_t bufferSize, std::string tmpDir) : 
+	fBufferSize(std::max<size_t>(bufferSize, 1)), fTmpDir(tmpDir), fNbOfHits(0){
+	fBuffer.reserve(fBufferSize);
+}
+
+HitSorter::~HitSorter(){
+	if(fPending.valid()) fPending.wait();
+	for(FILE* file : fRuns) fclose(file);
+}
+
+void HitSorter::Add(const CellHit& hit){
+	fBuffer.push_back(hit);
+	fNbOfHits++;
+	if(fBuffer.size() >= fBufferSize) Spill();
+}
+
+/// Hand the buffer to the background thread, one run at a time
+void HitSorter::Spill(){
+	if(fPending.valid()) fPending.get();
+	FILE* file = OpenTemporary();
+	fRuns.push_back(file);
+	fSpilling.swap(fBuffer);
+	fBuffer.clear();
+	fBuffer.reserve(fBufferSize);
+	fPending = std::async(std::launch::async, &HitSorter::SortAndWrite, &fSpilling, file);
+}
+
+void HitSorter::SortAndWrite(std::vector<CellHit>* hits, FILE* file){
+	std::stable_sort(hits->begin(), hits->end(), Earlier);
+	if(fwrite(hits->data(), sizeof(CellHit), hits->size(), file) != hits->size()){
+		throw std::runtime_error("HitSorter: cannot write the temporary run");
+	}
+	fflush(file);
+	hits->clear();
+}
+
+/// Temporary file removed as soon as it is closed
+FILE* HitSorter::OpenTemporary(){
+	FILE* file = nullptr;
+	if(fTmpDir.empty()) file = tmpfile();
+	else{
+		std::string name = fTmpDir + "/hitsXXXXXX";
+		int fd = mkstemp(&name[0]);
+		if(fd >= 0){
+			unlink(name.c_str());
+			file = fdopen(fd, "w+b");
+		}
+	}
+	if(!file) throw std::runtime_error("HitSorter: cannot create a temporary file");
+	return file;
+}
+
+void HitSorter::Merge(std::function<void(const CellHit&)> output){
+	// everything fits in memory
+	if(fRuns.empty()){
+		std::stable_sort(fBuffer.begin(), fBuffer.end(), Earlier);
+		for(auto& hit : fBuffer) output(hit);
+		fBuffer.clear();
+		fNbOfHits = 0;
+		return;
+	}
+
+	if(!fBuffer.empty()) Spill();
+	if(fPending.valid()) fPending.get();
+	fBuffer = std::vector<CellHit>();
+
+	std::vector<Run> runs(fRuns.size());
+	for(size_t i = 0; i < fRuns.size(); i++){
+		rewind(fRuns[i]);
+		runs[i].file = fRuns[i];
+		runs[i].pos = size_t(-1);
+	}
+
+	// heap of run indices, earliest hit first and lower run first on ties
+	auto later = [&runs](int a, int b){
+		const CellHit& ha = runs[a].block[runs[a].pos];
+		const CellHit& hb = runs[b].block[runs[b].pos];
+		if(ha.time != hb.time) return ha.time > hb.time;
+		return a > b;
+	};
+	std::priority_queue<int, std::vector<int>, decltype(later)> heap(later);
+	for(size_t i = 0; i < runs.size(); i++){
+		if(runs[i].Next()) heap.push(i);
+	}
+	while(!heap.empty()){
+		int i = heap.top();
+		heap.pop();
+		output(runs[i].block[runs[i].pos]);
+		if(runs[i].Next()) heap.push(i);
+	}
+
+	for(FILE* file : fRuns) fclose(file);
+	fRuns.clear();
+	fNbOfHits = 0;
+}
+
+
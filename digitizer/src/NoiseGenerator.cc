@@ -0,0 +1,110 @@
+/// \file  NoiseGenerator.cc
+/// \brief Implementation of the NoiseGenerator class
+
+#include "NoiseGenerator.hh"
+
+#include <complex>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// In place radix-2 FFT, n is a power of two, sign = +1 for the inverse
+	void FFT(std::vector<std::complex<double>>& a, int sign){
+		int n = a.size();
+		for(int i = 1, j = 0; i < n; i++){
+			int bit = n >> 1;
+			for(; j & bit; bit >>= 1) j ^= bit;
+			j ^= bit;
+			if(i < j) std::swap(a[i], a[j]);
+		}
+		for(int len = 2; len <= n; len <<= 1){
+			double angle = sign * 2 * M_PI / len;
+			std::complex<double> w(std::cos(angle), std::sin(angle));
+			for(int i = 0; i < n; i += len){
+				std::complex<double> wk(1, 0);
+				for(int k = 0; k < len / 2; k++){
+					std::complex<double> u = a[i + k], v = a[i + k + len / 2] * wk;
+					a[i + k] = u + v;
+					a[i + k + len / 2] = u - v;
+					wk *= w;
+				}
+			}
+		}
+	}
+}
+
+NoiseGenerator::NoiseGenerator(double pitch, double rms, double bandwidth, int blockSize, int nbOfTemplates, unsigned long seed) :
+	fPitch(pitch), fRMS(rms), fBlockSize(2), fNbOfTemplates(std::max(nbOfTemplates, 1)), fSeed(seed){
+	while(fBlockSize < blockSize) fBlockSize <<= 1;
+	SetSpectrum([bandwidth](double f){return 1 / (1 + (f / bandwidth) * (f / bandwidth));});
+}
+
+NoiseGenerator::~NoiseGenerator(){}
+
+void NoiseGenerator::SetSpectrum(std::function<double(double)> spectrum){
+	Synthesise(spectrum);
+}
+
+/// Tabulated spectrum: frequency (GHz) and density, linear interpolation
+bool NoiseGenerator::Load(const std::string& fileName){
+	std::ifstream myfile(fileName);
+	std::vector<double> x, y;
+	double tx, ty;
+	while(myfile >> tx >> ty){
+		x.push_back(tx);
+		y.push_back(ty);
+	}
+	if(x.size() < 2){
+		std::cerr << "NoiseGenerator: cannot read the spectrum from " << fileName << std::endl;
+		return false;
+	}
+	SetSpectrum([x, y](double f){
+		if(f < x.front() || f > x.back()) return 0.;
+		size_t i = std::upper_bound(x.begin(), x.end(), f) - x.begin();
+		if(i >= x.size()) return y.back();
+		return y[i - 1] + (y[i] - y[i - 1]) * (f - x[i - 1]) / (x[i] - x[i - 1]);
+	});
+	return true;
+}
+
+/// Amplitudes from the spectrum, random phases, no DC component
+void NoiseGenerator::Synthesise(std::function<double(double)> spectrum){
+	int n = fBlockSize;
+	std::vector<double> amplitude(n / 2 + 1, 0);
+	double power = 0;
+	for(int k = 1; k <= n / 2; k++){
+		double density = spectrum(k / (n * fPitch));
+		amplitude[k] = (density > 0) ? std::sqrt(density) : 0;
+		// the Nyquist bin has no negative frequency partner
+		power += (k < n / 2 ? 2 : 1) * amplitude[k] * amplitude[k];
+	}
+	// Parseval: every template has exactly this variance
+	double scale = (power > 0) ? fRMS * n / std::sqrt(power) : 0;
+
+	std::mt19937_64 engine(fSeed);
+	std::uniform_real_distribution<double> flat(0, 2 * M_PI);
+	std::vector<std::complex<double>> a(n);
+	fTemplates.resize(size_t(fNbOfTemplates) * n);
+	for(int t = 0; t < fNbOfTemplates; t++){
+		a[0] = 0;
+		for(int k = 1; k < n / 2; k++){
+			a[k] = std::polar(scale * amplitude[k], flat(engine));
+			a[n - k] = std::conj(a[k]);
+		}
+		a[n / 2] = scale * amplitude[n / 2] * (flat(engine) < M_PI ? 1 : -1);
+		FFT(a, 1);
+		for(int i = 0; i < n; i++) fTemplates[size_t(t) * n + i] = a[i].real() / n;
+	}
+}
+
+void NoiseGenerator::Block(double* out, unsigned long long random) const {
+	const double* block = &fTemplates[size_t(random % fNbOfTemplates) * fBlockSize];
+	int offset = (random >> 24) & (fBlockSize - 1);
+	double sign = (random >> 63) ? -1 : 1;
+	int n1 = fBlockSize - offset;
+	for(int i = 0; i < n1; i++) out[i] = sign * block[offset + i];
+	for(int i = n1; i < fBlockSize; i++) out[i] = sign * block[i - n1];
+}
@@ -0,0 +1,87 @@
+/// \file  PileupOverlay.cc
+/// \brief Implementation of the PileupOverlay class
+
+#include "PileupOverlay.hh"
+
+#include <algorithm>
+#include <limits>
+
+PileupOverlay::PileupOverlay(Output output) :
+	fOutput(output), fOffsets(1, 0), fMinTime(0), fDNRate(0), fNbOfCells(1), fNextDN(0),
+	fNbOfParticles(0), fNbOfHits(0){}
+
+PileupOverlay::~PileupOverlay(){}
+
+void PileupOverlay::AddResponse(const std::vector<CellHit>& hits){
+	CellHit event;
+	if(!hits.empty()) event = hits.front();
+	fEvents.push_back(event);
+	for(auto& hit : hits){
+		fCells.push_back(Cell{hit.timeEv, hit.element, hit.cell});
+		fMinTime = std::min(fMinTime, hit.timeEv);
+		if(std::find(fElements.begin(), fElements.end(), hit.element) == fElements.end()) fElements.push_back(hit.element);
+	}
+	fOffsets.push_back(fCells.size());
+}
+
+void PileupOverlay::SetDarkNoise(double rate, int nbOfCells){
+	fDNRate = rate;
+	fNbOfCells = std::max(nbOfCells, 1);
+}
+
+void PileupOverlay::Generate(double rate, double duration, std::mt19937_64& engine){
+	fNbOfParticles = 0;
+	fNbOfHits = 0;
+	if(fEvents.empty() || !(rate > 0)) return;
+	std::exponential_distribution<double> arrival(rate);
+	std::uniform_int_distribution<size_t> pick(0, fEvents.size() - 1);
+	if(fElements.empty()) fElements.push_back(0);
+	fNextDN = -1;
+
+	for(double t = arrival(engine); t < duration; t += arrival(engine)){
+		// the next particles cannot fire a cell earlier than this
+		Release(t + fMinTime, engine);
+		size_t i = pick(engine);
+		CellHit hit = fEvents[i];
+		hit.eventID = fNbOfParticles++;
+		hit.DN = 0;
+		for(size_t j = fOffsets[i]; j < fOffsets[i + 1]; j++){
+			hit.time = t + fCells[j].time;
+			hit.timeEv = fCells[j].time;
+			hit.element = fCells[j].element;
+			hit.cell = fCells[j].cell;
+			fPending.push(hit);
+		}
+	}
+	Release(duration, engine);
+	while(!fPending.empty()){
+		fOutput(fPending.top());
+		fPending.pop();
+		fNbOfHits++;
+	}
+}
+
+/// Give to the output the cells before time, with the dark noise up to it
+void PileupOverlay::Release(double time, std::mt19937_64& engine){
+	double rate = fDNRate * fElements.size();
+	if(rate > 0){
+		std::exponential_distribution<double> dark(rate);
+		std::uniform_int_distribution<size_t> element(0, fElements.size() - 1);
+		std::uniform_int_distribution<int> cell(0, fNbOfCells - 1);
+		if(fNextDN < 0) fNextDN = dark(engine);
+		CellHit hit;
+		hit.DN = 1;
+		hit.eventID = -1;
+		for(; fNextDN < time; fNextDN += dark(engine)){
+			hit.time = fNextDN;
+			hit.element = fElements[element(engine)];
+			hit.cell = cell(engine);
+			fPending.push(hit);
+		}
+	}
+	while(!fPending.empty() && fPending.top().time < time){
+		fOutput(fPending.top());
+		fPending.pop();
+		fNbOfHits++;
+	}
+}
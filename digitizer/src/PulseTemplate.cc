@@ -0,0 +1,50 @@
+/// \file  PulseTemplate.cc
+/// \brief Implementation of the PulseTemplate class
+
+#include "PulseTemplate.hh"
+
+#include <fstream>
+#include <iostream>
+
+PulseTemplate::PulseTemplate(double pitch, double length, int oversampling, double peak, double sigma, double tail) : 
+	fPitch(pitch), fSize(int(length / pitch) + 1), fOversampling(oversampling < 1 ? 1 : oversampling), 
+	fPeak(peak), fSigma(sigma), fTail(tail){
+	Tabulate();
+}
+
+PulseTemplate::~PulseTemplate(){}
+
+void PulseTemplate::SetShape(double peak, double sigma, double tail){
+	fPeak = peak;
+	fSigma = sigma;
+	fTail = tail;
+	Tabulate();
+}
+
+/// Read peak, sigma and tail (same order as Gp in signalsLiteNew.C)
+bool PulseTemplate::Load(const std::string& fileName){
+	std::ifstream myfile(fileName);
+	double peak, sigma, tail;
+	if(!(myfile >> peak >> sigma >> tail)){
+		std::cerr << "PulseTemplate: cannot read the shape from " << fileName << std::endl;
+		return false;
+	}
+	SetShape(peak, sigma, tail);
+	return true;
+}
+
+double PulseTemplate::Shape(double x, double peak, double sigma, double tail){
+	if(x < peak) return std::exp(-(x - peak) * (x - peak) / 2 / (sigma * sigma));
+	return std::exp(-(x - peak) * (x - peak) / 2 / (sigma * sigma + 0.5 * tail * x));
+}
+
+/// Row p is the pulse of an avalanche p / Oversampling pitches before a sample
+void PulseTemplate::Tabulate(){
+	fData.resize(fOversampling * fSize);
+	for(int p = 0; p < fOversampling; p++){
+		double phase = p * fPitch / fOversampling;
+		for(int i = 0; i < fSize; i++) fData[p * fSize + i] = Shape(i * fPitch + phase, fPeak, fSigma, fTail);
+	}
+}
+
+
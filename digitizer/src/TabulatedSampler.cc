@@ -0,0 +1,56 @@
+/// \file  TabulatedSampler.cc
+/// \brief Implementation of the TabulatedSampler class
+
+#include "TabulatedSampler.hh"
+
+#include <stdexcept>
+
+TabulatedSampler::TabulatedSampler(std::function<double(double)> density, double xMin, double xMax, int nBins) : 
+	fNbOfBins(nBins), fXMin(xMin), fWidth((xMax - xMin) / nBins), fMean(0){
+	if(nBins < 1 || !(xMax > xMin)) throw std::invalid_argument("TabulatedSampler: empty interval");
+
+	// Bin contents with the midpoint rule, negative values are not allowed
+	std::vector<double> w(nBins);
+	double sum = 0;
+	for(int i = 0; i < nBins; i++){
+		double x = xMin + (i + 0.5) * fWidth;
+		w[i] = density(x);
+		if(!(w[i] > 0)) w[i] = 0;
+		sum += w[i];
+		fMean += w[i] * x;
+	}
+	if(!(sum > 0)) throw std::invalid_argument("TabulatedSampler: null density");
+	fMean /= sum;
+
+	// Walker alias table (Vose's construction)
+	fBins.resize(nBins);
+	std::vector<double> p(nBins);
+	std::vector<int> small, large;
+	for(int i = 0; i < nBins; i++){
+		p[i] = w[i] * nBins / sum;
+		if(p[i] < 1) small.push_back(i);
+		else large.push_back(i);
+	}
+	while(!small.empty() && !large.empty()){
+		int s = small.back(), l = large.back();
+		small.pop_back();
+		fBins[s].prob = p[s];
+		fBins[s].alias = l;
+		p[l] -= 1 - p[s];
+		if(p[l] < 1){
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+	// left overs are full bins up to rounding
+	for(int i : large) fBins[i] = Bin{1, i};
+	for(int i : small) fBins[i] = Bin{1, i};
+}
+
+TabulatedSampler::~TabulatedSampler(){}
+
+void TabulatedSampler::Sample(double* u, int n) const {
+	for(int i = 0; i < n; i++) u[i] = Sample(u[i]);
+}
+
+
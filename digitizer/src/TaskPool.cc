@@ -0,0 +1,59 @@
+/// \file  TaskPool.cc
+/// \brief Implementation of the TaskPool class
+
+#include "TaskPool.hh"
+
+#include <thread>
+#include <exception>
+
+TaskPool::TaskPool(int nThreads) : fNbOfThreads(nThreads){
+	if(fNbOfThreads <= 0) fNbOfThreads = std::thread::hardware_concurrency();
+	if(fNbOfThreads <= 0) fNbOfThreads = 1;
+	for(int i = 0; i < fNbOfThreads; i++) fQueues.emplace_back(new Queue);
+}
+
+TaskPool::~TaskPool(){}
+
+void TaskPool::Run(std::vector<Task>& tasks){
+	for(size_t i = 0; i < tasks.size(); i++) fQueues[i % fNbOfThreads]->tasks.push_back(&tasks[i]);
+
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> errors(fNbOfThreads);
+	for(int i = 1; i < fNbOfThreads; i++){
+		threads.emplace_back([this, i, &errors](){
+			try{ Work(i); }
+			catch(...){ errors[i] = std::current_exception(); }
+		});
+	}
+	try{ Work(0); }
+	catch(...){ errors[0] = std::current_exception(); }
+	for(auto& thread : threads) thread.join();
+
+	for(auto& error : errors) if(error) std::rethrow_exception(error);
+}
+
+void TaskPool::Work(int worker){
+	while(Task* task = Pop(worker)) (*task)(worker);
+}
+
+/// Own queue first, then steal starting from the next worker
+TaskPool::Task* TaskPool::Pop(int worker){
+	for(int k = 0; k < fNbOfThreads; k++){
+		Queue& queue = *fQueues[(worker + k) % fNbOfThreads];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(queue.tasks.empty()) continue;
+		Task* task;
+		if(k == 0){
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+		}
+		else{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+		}
+		return task;
+	}
+	return nullptr;
+}
+
+
@@ -0,0 +1,34 @@
+/// \file  ThresholdScan.cc
+/// \brief Implementation of the ThresholdScan class
+
+#include "ThresholdScan.hh"
+
+#include <algorithm>
+
+ThresholdScan::ThresholdScan(int nBins, double max) : 
+	fNbOfBins(std::max(nBins, 1)), fNbOfChannels(0), fWidth(max / std::max(nBins, 1)){}
+
+ThresholdScan::~ThresholdScan(){}
+
+void ThresholdScan::Resize(int nChannels){
+	fNbOfChannels = nChannels;
+	fCounts.resize(size_t(nChannels) * fNbOfBins, 0);
+}
+
+void ThresholdScan::Add(const ThresholdScan& other){
+	if(other.fNbOfChannels > fNbOfChannels) Resize(other.fNbOfChannels);
+	for(size_t i = 0; i < other.fCounts.size(); i++) fCounts[i] += other.fCounts[i];
+}
+
+std::vector<long> ThresholdScan::GetCounts(int channel) const {
+	std::vector<long> counts(fNbOfBins, 0);
+	if(channel < 0 || channel >= fNbOfChannels) return counts;
+	long sum = 0;
+	for(int j = fNbOfBins - 1; j >= 0; j--){
+		sum += fCounts[size_t(channel) * fNbOfBins + j];
+		counts[j] = sum;
+	}
+	return counts;
+}
+
+
@@ -0,0 +1,42 @@
+/// \file  WaveSnippet.cc
+/// \brief Implementation of the WaveSnippet encoding
+
+#include "WaveSnippet.hh"
+
+#include <cstdint>
+
+void WaveSnippet::Encode(const std::vector<int>& adc, std::vector<unsigned char>& data){
+	data.clear();
+	int previous = 0;
+	for(int value : adc){
+		int32_t delta = value - previous;
+		previous = value;
+		uint32_t zigzag = (uint32_t(delta) << 1) ^ uint32_t(delta >> 31);
+		while(zigzag >= 0x80){
+			data.push_back((zigzag & 0x7f) | 0x80);
+			zigzag >>= 7;
+		}
+		data.push_back(zigzag);
+	}
+}
+
+void WaveSnippet::Decode(const std::vector<unsigned char>& data, std::vector<int>& adc){
+	adc.clear();
+	int previous = 0;
+	uint32_t zigzag = 0;
+	int shift = 0;
+	for(unsigned char byte : data){
+		zigzag |= uint32_t(byte & 0x7f) << shift;
+		if(byte & 0x80){
+			shift += 7;
+			continue;
+		}
+		int32_t delta = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+		previous += delta;
+		adc.push_back(previous);
+		zigzag = 0;
+		shift = 0;
+	}
+}
+
+
@@ -0,0 +1,230 @@
+/// \file  WaveformDigitizer.cc
+/// \brief Implementation of the WaveformDigitizer class
+
+#include "WaveformDigitizer.hh"
+
+#include <cmath>
+#include <algorithm>
+
+WaveformDigitizer::WaveformDigitizer(const PulseTemplate* pulse, double threshold, double window) : 
+	fPulse(pulse), fThreshold(threshold), fPitch(pulse->GetPitch()), 
+	fWindow(int(window / pulse->GetPitch())), fChargeNorm(2.6743304), fChannel(0), 
+	fNext(0), fEnd(0), fNbOfLateHits(0), fState(kIdle), fStart(0), fPrevTime(0), fCFDFraction(0.2), fPeak(0), 
+	fNoise(nullptr), fNoiseIndex(0), fHistoryMask(0), fSnapPre(-1), fSnapPost(0), fLSB(1), fCapturing(false), fCaptureEnd(0){
+	long size = 1;
+	while(size < fPulse->GetSize() + 1) size <<= 1;
+	fRing.assign(size, 0);
+	fRingNoSmearing.assign(size, 0);
+	fMask = size - 1;
+	// the rising edge of the longest signal
+	ResizeHistory(fWindow + fPulse->GetSize() + 1);
+}
+
+WaveformDigitizer::~WaveformDigitizer(){}
+
+/// Keep the waveform from pre samples before each crossing to post samples
+/// after, in ADC counts of lsb
+void WaveformDigitizer::SetSnapshot(int pre, int post, double lsb){
+	fSnapPre = pre;
+	fSnapPost = std::max(post, 0);
+	fLSB = lsb;
+	ResizeHistory(pre + 1);
+}
+
+void WaveformDigitizer::SetNoiseSeed(unsigned long seed){
+	fNoiseEngine.seed(seed);
+	fNoiseBlock.clear();
+	fNoiseIndex = 0;
+}
+
+void WaveformDigitizer::ResizeHistory(long n){
+	if(long(fHistory.size()) >= n) return;
+	long size = 1;
+	while(size < n) size <<= 1;
+	fHistory.assign(size, 0);
+	fHistoryIndex.assign(size, -1);
+	fHistoryMask = size - 1;
+}
+
+namespace {
+	// Contiguous multiply-add, written so that the compiler vectorises it
+	inline void Accumulate(double* __restrict out, double* __restrict outNoSmearing, 
+			       const double* __restrict pulse, double scale, int n){
+		for(int i = 0; i < n; i++){
+			out[i] += scale * pulse[i];
+			outNoSmearing[i] += pulse[i];
+		}
+	}
+}
+
+void WaveformDigitizer::AddHit(const CellHit& hit, double smearing){
+	long k0;
+	const double* pulse = fPulse->GetPulse(hit.time, k0);
+	// the samples are already finalized: the hit is moved to the first
+	// open sample and counted, the caller must not let this happen
+	if(k0 < fNext){
+		fNbOfLateHits++;
+		pulse = fPulse->GetPulse(fNext * fPitch, k0);
+	}
+	Advance(k0);
+
+	// the ring is split at most once
+	int n = fPulse->GetSize();
+	long j0 = k0 & fMask;
+	int n1 = std::min<long>(n, fMask + 1 - j0);
+	Accumulate(&fRing[j0], &fRingNoSmearing[j0], pulse, smearing, n1);
+	Accumulate(&fRing[0], &fRingNoSmearing[0], pulse + n1, smearing, n - n1);
+	fEnd = std::max(fEnd, k0 + n);
+	fLastHit = hit;
+}
+
+void WaveformDigitizer::AdvanceTo(double time){
+	Advance(long(std::floor(time / fPitch)));
+}
+
+/// Finalize all the pending samples and prepare for the next channel. With
+/// noise a signal can still be above threshold after the last pulse: the
+/// samples go on until it ends, at the latest at the end of its window.
+void WaveformDigitizer::Flush(){
+	Advance(std::max(fEnd + 1, fCapturing ? fCaptureEnd : 0));
+	if(fState == kActive) Advance(fStart + fWindow + 1);
+	if(fState == kActive){
+		fCurrent.timeOverThreshold = (fNext - 1) * fPitch - fCurrent.timeLE;
+		Finalize();
+	}
+	if(fCapturing) Advance(fCaptureEnd);
+	if(fCapturing) CloseCapture();
+	std::fill(fHistoryIndex.begin(), fHistoryIndex.end(), -1);
+	std::fill(fRing.begin(), fRing.end(), 0);
+	std::fill(fRingNoSmearing.begin(), fRingNoSmearing.end(), 0);
+	fNext = 0;
+	fEnd = 0;
+	fState = kIdle;
+	fPrevTime = 0;
+}
+
+/// Finalize the samples before the given one
+void WaveformDigitizer::Advance(long sample){
+	while(fNext < sample){
+		// only zeros ahead: nothing can cross the threshold
+		if(fNext >= fEnd && fState == kIdle && !fCapturing){
+			fNext = sample;
+			break;
+		}
+		ProcessSample(fNext);
+		fNext++;
+	}
+}
+
+void WaveformDigitizer::ProcessSample(long k){
+	long j = k & fMask;
+	double v = fRing[j];
+	double vNoSmearing = fRingNoSmearing[j];
+	fRing[j] = 0;
+	fRingNoSmearing[j] = 0;
+	if(fNoise){
+		if(fNoiseIndex >= int(fNoiseBlock.size())){
+			fNoiseBlock.resize(fNoise->GetBlockSize());
+			fNoise->Block(fNoiseBlock.data(), fNoiseEngine());
+			fNoiseIndex = 0;
+		}
+		v += fNoiseBlock[fNoiseIndex++];
+	}
+
+	bool idle = (fState == kIdle);
+	Discriminate(k, v, vNoSmearing);
+	if(fSnapPre >= 0) Capture(k, v, idle && fState != kIdle);
+	fHistory[k & fHistoryMask] = v;
+	fHistoryIndex[k & fHistoryMask] = k;
+}
+
+void WaveformDigitizer::Discriminate(long k, double v, double vNoSmearing){
+	if(fState == kIdle){
+		if(v > fThreshold){
+			fState = kActive;
+			fStart = k;
+			fCurrent = WaveSignal();
+			fCurrent.channel = fChannel;
+			fCurrent.time = k * fPitch;
+			fCurrent.timeEv = fLastHit.timeEv;
+			fCurrent.DN = fLastHit.DN;
+			fCurrent.trackLength = fLastHit.trackLength;
+			fCurrent.thetaIn = fLastHit.thetaIn;
+			fCurrent.secondaryID = fLastHit.secondaryID;
+			fCurrent.bounce = fLastHit.bounce;
+			fCurrent.eventID = fLastHit.eventID;
+			fCurrent.surfIn = fLastHit.surfIn;
+			double previous = History(k - 1);
+			fCurrent.timeLE = (k - 1 + (fThreshold - previous) / (v - previous)) * fPitch;
+			fPeak = k;
+		}
+		else return;
+	}
+	else if(fState == kWaitBelow){
+		if(v < fThreshold) fState = kIdle;
+		return;
+	}
+
+	fCurrent.charge += v * fPitch / fChargeNorm;
+	fCurrent.chargeNoSmearing += vNoSmearing * fPitch / fChargeNorm;
+	if(v < fThreshold){
+		double previous = History(k - 1);
+		fCurrent.timeOverThreshold = (k - 1 + (previous - fThreshold) / (previous - v)) * fPitch - fCurrent.timeLE;
+		Finalize();
+		fState = kIdle;
+		return;
+	}
+	if(k - fStart >= fWindow){
+		fCurrent.timeOverThreshold = k * fPitch - fCurrent.timeLE;
+		Finalize();
+		fState = kWaitBelow;
+		return;
+	}
+	if(v > fCurrent.amplitude){
+		fCurrent.amplitude = v;
+		fPeak = k;
+	}
+	fCurrent.amplitudeNoSmearing = std::max(fCurrent.amplitudeNoSmearing, vNoSmearing);
+}
+
+void WaveformDigitizer::Finalize(){
+	// constant fraction: back from the peak to the last sample below the level
+	double level = fCFDFraction * fCurrent.amplitude;
+	long i = fPeak, first = fPeak - fHistoryMask;
+	while(i > first && History(i - 1) >= level) i--;
+	double low = History(i - 1), high = History(i);
+	fCurrent.timeCFD = (high > low) ? (i - 1 + (level - low) / (high - low)) * fPitch : i * fPitch;
+
+	fCurrent.deltaTime = fPrevTime - fCurrent.time;
+	fPrevTime = fCurrent.time;
+	fSignals.push_back(fCurrent);
+}
+
+void WaveformDigitizer::Capture(long k, double v, bool trigger){
+	if(!fCapturing){
+		if(!trigger) return;
+		fCapturing = true;
+		fCapture.clear();
+		fSnippet = WaveSnippet();
+		fSnippet.channel = fChannel;
+		fSnippet.eventID = fCurrent.eventID;
+		fSnippet.time = (k - fSnapPre) * fPitch;
+		fSnippet.pitch = fPitch;
+		fSnippet.lsb = fLSB;
+		for(long i = k - fSnapPre; i < k; i++){
+			double h = (fHistoryIndex[i & fHistoryMask] == i) ? fHistory[i & fHistoryMask] : 0;
+			fCapture.push_back(int(std::lround(h / fLSB)));
+		}
+	}
+	fCapture.push_back(int(std::lround(v / fLSB)));
+	if(fState != kIdle) fCaptureEnd = k + 1 + fSnapPost;
+	if(k + 1 >= fCaptureEnd) CloseCapture();
+}
+
+void WaveformDigitizer::CloseCapture(){
+	WaveSnippet::Encode(fCapture, fSnippet.data);
+	fSnippets.push_back(fSnippet);
+	fCapturing = false;
+}
+
+
@@ -3,6 +3,8 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "ParameterSweep.hh"
+#include "PhysicsList.hh"
 
 #ifdef G4MULTITHREADED
 #include "G4MTRunManager.hh"
@@ -12,9 +14,6 @@
 
 #include <TTree.h>
 #include "G4UImanager.hh"
-#include "FTFP_BERT.hh"
-#include "G4OpticalPhysics.hh"
-#include "G4EmStandardPhysics_option4.hh"
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 #include "Randomize.hh"
@@ -22,10 +21,28 @@
 
 #include "G4Types.hh"
 
+#include <unistd.h>
+
+/// Usage: element [-p FTFP_BERT|lean] [macro]
 int main(int argc, char** argv){
+    G4String physics = "FTFP_BERT";
+    int opt;
+    while((opt = getopt(argc, argv, "p:")) != -1){
+        switch(opt){
+            case 'p': physics = optarg; break;
+            default:
+                G4cerr << "Usage: " << argv[0] << " [-p FTFP_BERT|lean] [macro]" << G4endl;
+                return 1;
+        }
+    }
+    if(!PhysicsList::IsConfiguration(physics)){
+        G4cerr << "Unknown physics configuration " << physics << " (FTFP_BERT or lean)" << G4endl;
+        return 1;
+    }
+
     // Detect interactive mode (if no macro) and define UI session
     G4UIExecutive* ui = 0;
-    if(argc == 1){
+    if(optind == argc){
         ui = new G4UIExecutive(argc, argv);
     }
 
@@ -39,22 +56,8 @@ int main(int argc, char** argv){
     // Set mandatory initialization classes
     runManager->SetUserInitialization(new DetectorConstruction);
     
-	G4VModularPhysicsList* physicsList = new FTFP_BERT;
-	physicsList->ReplacePhysics(new G4EmStandardPhysics_option4());
-	G4OpticalPhysics* opticalPhysics = new G4OpticalPhysics();
-
-	//opticalPhysics->SetWLSTimeProfile("delta");
-/*
-	opticalPhysics->SetScintillationYieldFactor(1.0);
-	opticalPhysics->SetScintillationExcitationRatio(0.0);
-
-	opticalPhysics->SetMaxNumPhotonsPerStep(100);
-	opticalPhysics->SetMaxBetaChangePerStep(10.0);
-*/	
-	opticalPhysics->SetTrackSecondariesFirst(kCerenkov, true);
-	opticalPhysics->SetTrackSecondariesFirst(kScintillation, true);
-
-	physicsList->RegisterPhysics(opticalPhysics);	
+	// Optical parameters with /Element/phys/
+	PhysicsList* physicsList = new PhysicsList(physics);
 	runManager->SetUserInitialization(physicsList);
 
     // Set user action initialization
@@ -67,12 +70,15 @@ int main(int argc, char** argv){
     // Get the pointer to the User Interface manager
     G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
+    // Sweeps of the parameters in the same process (/Element/sweep/)
+    ParameterSweep* sweep = new ParameterSweep();
+
 
     // Process macro or start UI session
     if(!ui){
         // batch mode
         G4String command  = "/control/execute ";
-		G4String fileName = argv[1];
+		G4String fileName = argv[optind];
         UImanager->ApplyCommand(command + fileName);
     }
     else{
@@ -88,6 +94,7 @@ int main(int argc, char** argv){
     }
 
     // Job termination
+    delete sweep;
     delete visManager;
     delete runManager;
 }
@@ -0,0 +1,56 @@
+/// \file  BeamSpectrum.hh
+/// \brief Definition of the BeamSpectrum class
+
+#ifndef BeamSpectrum_h
+#define BeamSpectrum_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <functional>
+
+/// Tabulated one or two dimensional distribution of the beam
+///
+/// The table is read from a text file, one point per line:
+///   1D: x density [sampling]
+///   2D: x y density [sampling], on a regular grid (every x with every y)
+/// Each point is in a bin bounded by the midpoints with its neighbours, the
+/// first and last points bound the outer bins so that the sampled values
+/// stay in the tabulated range; the position inside the bin is uniform. The bins are drawn
+/// in O(1) with a Walker alias table built when the table is loaded. When
+/// the sampling column is given the bins are drawn with it instead of the
+/// density and the weight density / sampling (normalised to 1 on average)
+/// is returned, so that a biased spectrum can be reweighted in the analysis.
+
+class BeamSpectrum{
+	public:
+		BeamSpectrum();
+		~BeamSpectrum();
+
+		G4bool Load(G4String fileName, G4int dimension);
+		// 1D density on [xMin, xMax] tabulated on nBins bins
+		void Tabulate(std::function<G4double(G4double)> density, G4double xMin, G4double xMax, G4int nBins);
+		// Michel spectrum of the positrons of muon decay (electron mass
+		// neglected), x is the kinetic energy
+		void Michel();
+
+		inline G4int GetDimension() const {return fY.empty() ? 1 : 2;}
+
+		// x (and y in 2D) from two uniform numbers, returns the weight
+		G4double Sample(G4double u, G4double v, G4double& x, G4double& y) const;
+
+	private:
+		void Build(std::vector<G4double> density, std::vector<G4double> sampling);
+		static void Edges(const std::vector<G4double>& centres, std::vector<G4double>& edges);
+
+		struct Bin{
+			G4double prob;
+			G4int alias;
+		};
+
+		std::vector<G4double> fX, fY; // bin edges
+		std::vector<Bin> fBins;       // x index major
+		std::vector<G4double> fWeight;
+};
+
+#endif
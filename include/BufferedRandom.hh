@@ -0,0 +1,59 @@
+/// \file  BufferedRandom.hh
+/// \brief Definition of the BufferedRandom class
+
+#ifndef BufferedRandom_h
+#define BufferedRandom_h 1
+
+#include "globals.hh"
+
+/// Per-thread buffer of random numbers
+///
+/// Uniform and exponential deviates are produced in blocks through the
+/// flatArray() interface of the thread engine and served one at a time.
+/// Reset() drops what is left in the buffers: it is called when the primaries
+/// are generated so that every event only uses numbers from its own seeds.
+/// The blocks start small after Reset() and double at each refill up to
+/// kBlockSize, so that the events drawing few numbers (e.g. single photon
+/// runs) do not generate and drop whole blocks.
+
+class BufferedRandom{
+	public:
+		static BufferedRandom* GetInstance();
+
+		// Uniform in (0, 1)
+		inline G4double Flat(){
+			if(fFlatIndex == fFlatSize) FillFlat();
+			return fFlat[fFlatIndex++];
+		}
+
+		// Exponential with the given mean
+		inline G4double Exponential(G4double mean){
+			if(fExpIndex == fExpSize) FillExponential();
+			return mean * fExp[fExpIndex++];
+		}
+
+		inline void Reset(){
+			fFlatIndex = fFlatSize = fExpIndex = fExpSize = 0;
+			fFlatNext = fExpNext = kFirstBlockSize;
+		}
+
+	private:
+		BufferedRandom();
+		void FillFlat();
+		void FillExponential();
+
+		static const G4int kFirstBlockSize = 8;
+		static const G4int kBlockSize = 256;
+
+		G4double fFlat[kBlockSize];
+		G4double fExp[kBlockSize];
+		// served index, filled size and size of the next fill
+		G4int fFlatIndex, fFlatSize, fFlatNext;
+		G4int fExpIndex, fExpSize, fExpNext;
+
+		static G4ThreadLocal BufferedRandom* fInstance;
+};
+
+#endif
+
+
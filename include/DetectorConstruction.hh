@@ -10,6 +10,11 @@
 #include "PixelSD.hh"
 #include "G4Cache.hh"
 
+#include <atomic>
+#include <set>
+#include <cstdint>
+#include <map>
+
 class G4VPhysicalVolume;
 class G4VLogicallVolume;
 class G4Box;
@@ -18,6 +23,9 @@ class G4Material;
 class G4Element;
 class G4MaterialPropertiesTable;
 class DetectorMessenger;
+class G4Region;
+class G4ProductionCuts;
+class G4UserLimits;
 
 /// Detector construction class to define geometry
 
@@ -36,14 +44,32 @@ class DetectorConstruction : public G4VUserDetectorConstruction{
     	void SetCrystalSize(G4ThreeVector);
 	void SetCrystalMaterial(G4String);
 	void SetSiPMmodel(G4String);
+	void SetSiPMCatalogue(G4String);
 	void SetGround(G4double);
 	void SetAngle(G4double);
 	void SetAngleWithOpticalGrease(G4double);
 	void SetTilt(G4double);
+	void SetVirtualPixels(G4bool);
+
+	// Regions: Crystal, SiPM (window and pixels) and Transport (the rest of
+	// the element); a value <= 0 restores the default (global cuts, no limit)
+	void SetRegionCut(G4String region, G4double val);
+	void SetRegionStepLimit(G4String region, G4double val);
+
+	// Between BeginChanges() and CommitChanges() the geometry is rebuilt
+	// once, at the commit, whatever the number of parameters changed
+	void BeginChanges();
+	void CommitChanges();
+	// a run started with an open group is aborted (RunAction)
+	G4bool HasOpenChanges() const {return fDeferChanges;}
 
 	G4int GetNbOfPixels(){return fNbOfPixelsX * fNbOfPixelsY;}
 
 	G4String GetSiPMmodel(){return fmodel;}
+
+	// Changed whenever the geometry is built or modified: the classes that
+	// cache geometry information compare it with the value they cached
+	static G4int GetGeometryVersion(){return fGeometryVersion;}
 	
 	
     private:
@@ -54,6 +80,13 @@ class DetectorConstruction : public G4VUserDetectorConstruction{
 	void DefineMaterials();
 
 	G4VPhysicalVolume* DefineVolumes();
+	void RebuildGeometry();
+	void GeometryModified();
+	uint64_t GeometryHash();
+	G4bool CheckOverlaps(G4LogicalVolume* volume, std::set<G4LogicalVolume*>& checked);
+	void DefineRegions();
+	void SetRegionRoot(G4String name, G4LogicalVolume* volume);
+	void SetRegionLimits(G4LogicalVolume* volume, G4UserLimits* limits);
 	G4VPhysicalVolume* fCrysVolume;
 	G4VPhysicalVolume* fSiPMVolume;
 	G4VPhysicalVolume* fElementVolume;
@@ -62,6 +95,8 @@ class DetectorConstruction : public G4VUserDetectorConstruction{
 	G4Box* fSolidWorld;
 	G4Box* fSolidElement;
 	G4bool fCheckOverlaps;
+	G4bool fVirtualPixels;
+	G4bool fDeferChanges, fRebuildPending, fModifiedPending;
 	G4int fNbOfPixelsX, fNbOfPixelsY;
 
 	G4LogicalVolume* fLogicPixel;
@@ -99,6 +134,17 @@ class DetectorConstruction : public G4VUserDetectorConstruction{
 	G4Cache<ScintSD*> fScint_SD;
 	G4Cache<PixelSD*> fPixel_SD;
 
+	struct RegionSettings{
+		G4Region* region;
+		G4ProductionCuts* cuts; // kept for the region, the couples point to it
+		G4bool defaultCuts;     // cuts not used, the region has the default cuts
+		G4UserLimits* limits;
+		G4LogicalVolume* root;
+	};
+	std::map<G4String, RegionSettings> fRegions;
+
+	static std::atomic<G4int> fGeometryVersion;
+
 };
 
 #endif
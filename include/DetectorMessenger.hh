@@ -13,10 +13,18 @@ class G4UIcmdWithAString;
 class G4UIcmdWithADoubleAndUnit;
 class G4UIcmdWith3VectorAndUnit;
 class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+class G4UIcmdWithoutParameter;
+class G4UIcommand;
 
 /// it implements command:
 /// - /Element/det/SetCrysSize value unit
 /// - /Element/det/SiPMmodel string
+/// - /Element/det/SiPMCatalogue file
+/// - /Element/det/begin ... /Element/det/commit
+/// - /Element/det/CacheDir directory
+/// - /Element/det/RegionCut region value unit
+/// - /Element/det/RegionStepLimit region value unit
 
 class DetectorMessenger : public G4UImessenger{
 	public:
@@ -39,6 +47,13 @@ class DetectorMessenger : public G4UImessenger{
 		G4UIcmdWith3VectorAndUnit* fCrysSizeCmd3;
 		G4UIcmdWithAString* fCrysMaterialCmd;
 		G4UIcmdWithAString* fSiPMmodelCmd;
+		G4UIcmdWithAString* fSiPMCatalogueCmd;
+		G4UIcmdWithABool* fVirtualPixelsCmd;
+		G4UIcmdWithoutParameter* fBeginCmd;
+		G4UIcmdWithoutParameter* fCommitCmd;
+		G4UIcmdWithAString* fCacheDirCmd;
+		G4UIcommand* fRegionCutCmd;
+		G4UIcommand* fRegionStepLimitCmd;
 };
 
 #endif
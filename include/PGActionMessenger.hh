@@ -11,6 +11,8 @@ class PrimaryGeneratorAction;
 class G4UIdirectory;
 class G4UIcmdWithABool;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithAString;
 
 class PGActionMessenger : public G4UImessenger{
 	public:
@@ -26,6 +28,12 @@ class PGActionMessenger : public G4UImessenger{
 
 		G4UIcmdWithABool* fCmdOCT;
 		G4UIcmdWithADoubleAndUnit* fCmdDivergence;
+		G4UIcmdWithAnInteger* fCmdBatch;
+		G4UIcmdWithAString* fCmdPhaseSpace;
+		G4UIcmdWithABool* fCmdPhaseSpaceRecycle;
+		G4UIcmdWithAString* fCmdEnergySpectrum;
+		G4UIcmdWithAString* fCmdAngularSpectrum;
+		G4UIcmdWithAString* fCmdAngularSpectrum2D;
 };
 
 #endif
@@ -0,0 +1,48 @@
+/// \file  ParameterSweep.hh
+/// \brief Definition of the ParameterSweep class
+
+#ifndef ParameterSweep_h
+#define ParameterSweep_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class SweepMessenger;
+
+/// Runs of several configurations in the same process
+///
+/// The points of the sweep are either the grid of the values given for
+/// each parameter or the rows of a list file (a header line with the
+/// parameter names, then one point per line). The parameters are
+///   CrysSize [mm], CrysMaterial, SiPMmodel, Angle [deg], AngleWOG [deg],
+///   Tilt [mm], Ground, Energy [MeV], Particle
+/// or any UI command, whose value is appended to it. The detector changes
+/// of a point are grouped in a single geometry rebuild and the physics
+/// tables are kept from one point to the next (only the new materials are
+/// added), so a point costs its events and not a whole start up. Each
+/// point writes prefix_<name>-<value>...root.
+
+class ParameterSweep{
+	public:
+		ParameterSweep();
+		~ParameterSweep();
+
+		// New grid axis: every point so far is repeated for each value
+		void AddAxis(G4String name, std::vector<G4String> values);
+		G4bool LoadList(G4String fileName);
+		void Clear();
+
+		void Run(G4int nEvents, G4String prefix);
+
+	private:
+		G4String Command(const G4String& name, const G4String& value);
+
+		std::vector<G4String> fNames;
+		std::vector<std::vector<G4String>> fPoints;
+		SweepMessenger* fMessenger;
+};
+
+#endif
+
+
@@ -0,0 +1,58 @@
+/// \file  PhaseSpaceSource.hh
+/// \brief Definition of the PhaseSpaceSource class
+
+#ifndef PhaseSpaceSource_h
+#define PhaseSpaceSource_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <cstdint>
+
+class G4ParticleGun;
+class G4ParticleDefinition;
+
+/// Primary particles read from a binary phase-space file
+///
+/// The file is a plain array of records of 32 bytes (native byte order):
+///   float x, y, z [mm], px, py, pz [MeV/c], t [ns]; int32 PDG code
+/// It is memory mapped read-only by each worker, which reads only its own
+/// slice: the records are divided in equal contiguous parts in the order of
+/// the thread IDs, so the threads share nothing but the page cache. At the
+/// end of its slice a worker either stops or reads it again with every
+/// record rotated by a random angle around the beam (z) axis.
+
+class PhaseSpaceSource{
+	public:
+		PhaseSpaceSource(G4String fileName, G4bool recycle);
+		~PhaseSpaceSource();
+
+		void SetRecycle(G4bool val){fRecycle = val;}
+
+		// Set the gun to the next record, false at the end of the slice
+		G4bool Next(G4ParticleGun* gun);
+
+		inline size_t GetNbOfRecords() const {return fNbOfRecords;}
+
+	private:
+		struct Record{
+			float x, y, z;
+			float px, py, pz;
+			float t;
+			int32_t PDG;
+		};
+
+		G4ParticleDefinition* GetParticle(G4int PDG);
+
+		G4String fFileName;
+		G4bool fRecycle;
+		void* fMap;
+		size_t fMapSize;
+		const Record* fRecords;
+		size_t fNbOfRecords;
+		size_t fFirst, fLast, fIndex;
+		G4int fPass;
+		std::map<G4int, G4ParticleDefinition*> fParticles;
+};
+
+#endif
@@ -0,0 +1,42 @@
+/// \file  PhysicsList.hh
+/// \brief Definition of the PhysicsList class
+
+#ifndef PhysicsList_h
+#define PhysicsList_h 1
+
+#include "globals.hh"
+#include "G4VModularPhysicsList.hh"
+
+class G4OpticalPhysics;
+class PhysicsListMessenger;
+
+/// Physics of the simulation, chosen with element -p configuration
+///
+/// - FTFP_BERT (default): the FTFP_BERT constructors with the option 4 of
+///   the standard EM physics, plus the optical physics
+/// - lean: option 4 EM, decay and optical physics only, enough for the
+///   positrons and muons of a few tens of MeV shot at the element; no
+///   hadronic process is built nor attached to the particles
+/// Both have the step limiter used by the regions of DetectorConstruction.
+/// The optical parameters are set with /Element/phys/ before /run/initialize.
+
+class PhysicsList : public G4VModularPhysicsList{
+	public:
+		PhysicsList(G4String configuration = "FTFP_BERT");
+		virtual ~PhysicsList();
+
+		static G4bool IsConfiguration(G4String configuration);
+
+		void SetMaxNumPhotonsPerStep(G4int val);
+		void SetMaxBetaChangePerStep(G4double val);
+		void SetScintillationByParticleType(G4bool val);
+		void SetTrackSecondariesFirst(G4bool val);
+
+	private:
+		G4OpticalPhysics* fOpticalPhysics;
+		PhysicsListMessenger* fMessenger;
+};
+
+#endif
+
+
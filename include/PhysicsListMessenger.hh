@@ -0,0 +1,42 @@
+/// \file  PhysicsListMessenger.hh
+/// \brief Definition of the PhysicsListMessenger class
+
+#ifndef PhysicsListMessenger_h
+#define PhysicsListMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class PhysicsList;
+class G4UIdirectory;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
+class G4UIcmdWithABool;
+
+/// it implements command:
+/// - /Element/phys/MaxPhotonsPerStep n
+/// - /Element/phys/MaxBetaChange percent
+/// - /Element/phys/ScintByParticleType bool
+/// - /Element/phys/TrackSecondariesFirst bool
+
+class PhysicsListMessenger : public G4UImessenger{
+	public:
+		PhysicsListMessenger(PhysicsList*);
+		virtual ~PhysicsListMessenger();
+
+		virtual void SetNewValue(G4UIcommand*, G4String);
+
+	private:
+		PhysicsList* fPhysicsList;
+
+		G4UIdirectory* fPhysDirectory;
+
+		G4UIcmdWithAnInteger* fMaxPhotonsCmd;
+		G4UIcmdWithADouble* fMaxBetaChangeCmd;
+		G4UIcmdWithABool* fScintByParticleTypeCmd;
+		G4UIcmdWithABool* fTrackSecondariesFirstCmd;
+};
+
+#endif
+
+
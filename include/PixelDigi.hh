@@ -0,0 +1,51 @@
+/// \file  PixelDigi.hh
+/// \brief Definition of the PixelDigi class
+
+#ifndef PixelDigi_h
+#define PixelDigi_h 1
+
+#include "G4VDigi.hh"
+#include "G4TDigiCollection.hh"
+#include "G4Allocator.hh"
+
+#include "CellHit.hh"
+
+#include "tls.hh"
+
+/// Discriminated SiPM signal of one readout channel, same content as an
+/// entry of the waves tree of the digitizer
+
+class PixelDigi : public G4VDigi{
+	public:
+		PixelDigi();
+		PixelDigi(const WaveSignal& signal);
+		virtual ~PixelDigi();
+
+		inline void *operator new(size_t);
+		inline void operator delete(void *aDigi);
+
+		virtual void Draw(){}
+		virtual void Print();
+
+		inline const WaveSignal& GetSignal() const {return fSignal;}
+
+	private:
+		WaveSignal fSignal;
+};
+
+typedef G4TDigiCollection<PixelDigi> PixelDigiCollection;
+
+extern G4ThreadLocal G4Allocator<PixelDigi>* PixelDigiAllocator;
+
+inline void* PixelDigi::operator new(size_t){
+	if(!PixelDigiAllocator) PixelDigiAllocator = new G4Allocator<PixelDigi>;
+	return (void*) PixelDigiAllocator->MallocSingle();
+}
+
+inline void PixelDigi::operator delete(void* aDigi){
+	PixelDigiAllocator->FreeSingle((PixelDigi*) aDigi);
+}
+
+#endif
+
+
@@ -0,0 +1,72 @@
+/// \file  PixelDigitizer.hh
+/// \brief Definition of the PixelDigitizer class
+
+#ifndef PixelDigitizer_h
+#define PixelDigitizer_h 1
+
+#include "G4VDigitizerModule.hh"
+#include "globals.hh"
+
+#include "PixelDigi.hh"
+#include "CellHit.hh"
+#include "ChannelMap.hh"
+#include "ChannelSplitter.hh"
+#include "PulseTemplate.hh"
+#include "WaveformDigitizer.hh"
+#include "NoiseGenerator.hh"
+#include "TabulatedSampler.hh"
+
+#include <vector>
+#include <queue>
+#include <memory>
+
+class RunAction;
+
+/// Digitizer module of the SiPM signals
+///
+/// The fired cells of the PixelHitsCollection go through the same chain as
+/// the offline tools (order, split, digitize): time ordering, channel map
+/// with per-cell dead time and the streaming waveform digitizer. The chain
+/// spans the whole run, so pile-up between events is kept: the cells are
+/// held back for a latency after the gun time of the event, since the
+/// next events may still fire cells earlier than that. Each call of
+/// Digitize() stores the signals completed so far in the PixelDigiCollection.
+/// The CFD fraction and the baseline noise are set as in digitize; the
+/// waveform snippets are written by the offline digitize only.
+
+class PixelDigitizer : public G4VDigitizerModule{
+	public:
+		PixelDigitizer(G4String name);
+		virtual ~PixelDigitizer();
+
+		virtual void Digitize();
+
+		// Settings from the RunAction commands, at the beginning of the run
+		void BeginOfRun(RunAction* action);
+		// Signals still pending at the end of the run
+		std::vector<WaveSignal> EndOfRun();
+
+	private:
+		void Release(G4double time);
+		void Collect(std::vector<WaveSignal>& signals);
+		WaveformDigitizer* GetChannel(G4int channel);
+
+		struct Later{
+			bool operator()(const CellHit& a, const CellHit& b) const {return a.time > b.time;}
+		};
+
+		G4int fCollIDSiPM, fCollIDScint;
+		G4double fThreshold, fLatency, fCFDFraction;
+		unsigned long fNoiseSeed;
+		ChannelMap fChannelMap;
+		std::unique_ptr<ChannelSplitter> fSplitter;
+		std::unique_ptr<PulseTemplate> fPulse;
+		std::unique_ptr<TabulatedSampler> fSmearing;
+		std::unique_ptr<NoiseGenerator> fNoise;
+		std::vector<std::unique_ptr<WaveformDigitizer>> fChannels;
+		std::priority_queue<CellHit, std::vector<CellHit>, Later> fPending;
+};
+
+#endif
+
+
@@ -9,6 +9,7 @@
 #include "G4Allocator.hh"
 #include "G4LogicalVolume.hh"
 #include "G4VPhysicalVolume.hh"
+#include "G4ThreeVector.hh"
 
 #include "tls.hh"
 
@@ -35,6 +36,7 @@ class PixelHit : public G4VHit{
 		inline void SetCellTime(std::vector<G4double> val){fCellTime = val;}
 		inline void SetOCTFlag(std::vector<G4int> val){fOCTflag = val;}
 		inline void SetDNFlag(std::vector<G4int> val){fDNflag = val;}
+		inline void SetAPFlag(std::vector<G4int> val){fAPflag = val;}
 
 		inline G4int GetNCells(){return fNCells;}
 		inline G4double GetNPhotoElectrons(){return fNPhotoElectrons;}
@@ -42,10 +44,11 @@ class PixelHit : public G4VHit{
 		inline std::vector<G4double> GetCellTime(){return fCellTime;}
 		inline std::vector<G4int> GetOCTFlag(){return fOCTflag;}
 		inline std::vector<G4int> GetDNFlag(){return fDNflag;}
+		inline std::vector<G4int> GetAPFlag(){return fAPflag;}
 
 		inline void Clear(){fNCells = 0; fNPhotoElectrons = 0; fCells.clear(); 
 			fCellTime.clear(); fPhysVol = nullptr; fDrawit = false; fPixelNumber = -1; 
-			fOCTflag.clear(); fDNflag.clear();
+			fOCTflag.clear(); fDNflag.clear(); fAPflag.clear(); fPixelHalfSize = G4ThreeVector();
 		}
 
 		inline void SetPixelPhysVol(G4VPhysicalVolume* physVol){this->fPhysVol = physVol;}
@@ -57,6 +60,10 @@ class PixelHit : public G4VHit{
 		inline void SetPixelPhysVolGMother(G4VPhysicalVolume* physVol){this->fPhysVolGMother = physVol;}
 		inline G4VPhysicalVolume* GetPixelPhysVolGMother(){return fPhysVolGMother;}
 
+		// Position and size of a virtual pixel inside its physical volume
+		inline void SetPixelOffset(G4ThreeVector val){fPixelOffset = val;}
+		inline void SetPixelHalfSize(G4ThreeVector val){fPixelHalfSize = val;}
+
 		inline void SetDrawit(G4bool b){fDrawit=b;}
 		inline G4bool GetDrawit(){return fDrawit;}
 
@@ -70,9 +77,12 @@ class PixelHit : public G4VHit{
 		std::vector<G4double> fCellTime;
 		std::vector<G4int> fOCTflag;
 		std::vector<G4int> fDNflag;
+		std::vector<G4int> fAPflag;
 		G4VPhysicalVolume* fPhysVol;
 		G4VPhysicalVolume* fPhysVolMother;
 		G4VPhysicalVolume* fPhysVolGMother;
+		G4ThreeVector fPixelOffset;
+		G4ThreeVector fPixelHalfSize;
 		G4bool fDrawit;
 		G4int fPixelNumber;
 };
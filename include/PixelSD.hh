@@ -6,6 +6,7 @@
 
 #include "PixelHit.hh"
 #include "SiPMModel.hh"
+#include "SiPMCellState.hh"
 
 #include "G4VSensitiveDetector.hh"
 #include "G4OpticalPhoton.hh"
@@ -13,6 +14,9 @@
 class G4Step;
 class G4HCofThisEvent;
 class G4VLogicalVolume;
+class G4Box;
+class BufferedRandom;
+struct SiPMDevice;
 class PixelSDMessenger;
 
 class PixelSD : public G4VSensitiveDetector{
@@ -37,38 +41,49 @@ class PixelSD : public G4VSensitiveDetector{
 		inline G4String GetFileName(G4int i){return filename[i];}
 		inline void SetNbOfPixels(G4int val){fNbOfPixels = val;}
 		inline G4int GetNbOfPixels(){return fNbOfPixels;}
+		inline void SetVirtualPixels(G4bool val){fVirtualPixels = val;}
 
 		void DefineProperties();
 		void SetModel(G4String name){fModel = name;}
 
 	private:
+		void Afterpulse(G4int cell, G4double time, G4double ptime);
+		void SaturationResponse();
+		G4int GetVirtualPixel(const G4ThreeVector& localPos, const G4Box* box);
+
+
 		PixelSDMessenger* fPixelMessenger;
 
 		PixelHitsCollection* fPixelCollection;
 		PixelHitsCollection* fPixelCollectionDraw;
 		G4int fNCells, fNbOfPixels;
+		G4int fNDetected;
+		G4int fNbOfPixelsX, fNbOfPixelsY;
+		G4bool fVirtualPixels;
 		G4double fNPhotoElectrons;
 		std::vector<G4int> fCells;
 		std::vector<G4double> fCellTime;
 		G4int fOCTflag;
 		std::vector<G4int> fOCTflagvec;
 		std::vector<G4int> fDNflagvec;
+		std::vector<G4int> fAPflagvec;
 
 		G4double fVoltage;
-		std::vector<G4double> fDetEff;
-		std::vector<G4double> fDetEffx;
+		const SiPMDevice* fDevice;
 		G4double fDetEffGain;
 		G4double fPhotonGain;
 		G4double fOCT;
 
 		G4double fFillFactor;
+		G4double fAfterpulseProb, fAfterpulseTau;
 		
-		std::vector<G4int> firstStep;
-		std::vector<G4double> activationTime;
-		std::vector<G4int> isParent;
+		SiPMCellState fCellState;
+		BufferedRandom* fRandom;
 
 		G4bool fCmdOCT;
 		G4bool fCmdDN;
+		G4bool fCmdAP;
+		G4bool fCmdSaturation;
 
 		G4String fModel;
 		G4String filename[4];
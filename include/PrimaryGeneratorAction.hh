@@ -7,14 +7,33 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleGun.hh"
 #include "globals.hh"
+#include "G4ThreeVector.hh"
+
+#include <vector>
 
 class G4ParticleGun;
 class G4Event;
+class G4ParticleDefinition;
 class PGActionMessenger;
+class PhaseSpaceSource;
+class BeamSpectrum;
 
 ///Primary generator action class with particle gun
 ///
 /// The default energy is 2 MeV, monochromatic positron
+///
+/// The gun geometry is looked up once per geometry version (see
+/// DetectorConstruction::GetGeometryVersion()). With a batch size N > 1 the
+/// vertices of N events are generated at once from the random numbers of
+/// the first of them.
+///
+/// With a phase-space file the primaries are read from it instead (see
+/// PhaseSpaceSource), the file is opened by each thread at its first event.
+///
+/// The kinetic energy and the direction can be drawn from tabulated
+/// spectra (see BeamSpectrum): energy in MeV, theta (and phi) in deg with
+/// the same convention as the divergence mode. The product of their
+/// sampling weights is the weight of the primary vertex.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction{
     public:
@@ -24,16 +43,55 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction{
         //method of the base class
         virtual void GeneratePrimaries(G4Event*);
 	const G4ParticleGun* GetParticleGun() const {return fParticleGun;}
-	void SetOCT(G4bool val){fOCTrun = val;}
-	void SetDivergence(G4double val){fDivergence = val;}
+	void SetOCT(G4bool val){fOCTrun = val; fBatchIndex = fBatch.size();}
+	void SetDivergence(G4double val){fDivergence = val; fBatchIndex = fBatch.size();}
+	void SetBatchSize(G4int val){fBatchSize = val; fBatchIndex = fBatch.size();}
+	void SetPhaseSpace(G4String fileName);
+	void SetPhaseSpaceRecycle(G4bool val);
+	void SetEnergySpectrum(G4String fileName);
+	void SetAngularSpectrum(G4String fileName, G4int dimension);
     
     private:
+	void UpdateGeometry();
+	void FillBatch();
+
+	struct Vertex{
+		G4ThreeVector position, direction;
+		G4double energy; // < 0: the one of the gun
+		G4double weight;
+	};
+
         G4ParticleGun* fParticleGun; // pointer to G4 gun class
 	PGActionMessenger* fMessenger;
 
 	G4double fDivergence;
 
 	G4bool fOCTrun;
+
+	// Cached geometry
+	G4int fGeometryVersion;
+	G4double fGunZ, fGunZDivergence;
+	G4ParticleDefinition* fOpticalPhoton;
+
+	// Pre-generated vertices
+	G4int fBatchSize;
+	std::vector<Vertex> fBatch;
+	size_t fBatchIndex;
+
+	// Phase-space file
+	G4String fPhaseSpaceFile;
+	G4bool fPhaseSpaceRecycle;
+	PhaseSpaceSource* fPhaseSpace;
+	// gun settings while the phase-space file is used
+	G4ParticleDefinition* fSavedParticle;
+	G4double fSavedEnergy;
+	G4ThreeVector fSavedDirection;
+
+	// Tabulated spectra
+	BeamSpectrum* fEnergySpectrum;
+	BeamSpectrum* fAngularSpectrum;
+	// gun energy while the energy spectrum is used
+	G4double fGunEnergy;
 };
 
 #endif
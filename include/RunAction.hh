@@ -8,6 +8,7 @@
 #include "globals.hh"
 #include "G4ThreeVector.hh"
 #include "Randomize.hh"
+#include "BufferedRandom.hh"
 
 #include <vector>
 
@@ -17,6 +18,8 @@ class G4Run;
 class TFile;
 class TTree;
 class RunActionMessenger;
+class WaveWriter;
+struct WaveSignal;
 
 /// Run action class
 ///
@@ -64,6 +67,38 @@ class RunAction : public G4UserRunAction {
 
 		void SetCmdDN(G4bool cmd){fCmdDN = cmd;}
 		G4bool GetCmdDN(){return fCmdDN;}
+
+		void SetCmdAP(G4bool cmd){fCmdAP = cmd;}
+		G4bool GetCmdAP(){return fCmdAP;}
+
+		void SetCmdRecovery(G4bool cmd){fCmdRecovery = cmd;}
+		G4bool GetCmdRecovery(){return fCmdRecovery;}
+
+		void SetCmdSaturation(G4bool cmd){fCmdSaturation = cmd;}
+		G4bool GetCmdSaturation(){return fCmdSaturation;}
+		
+		// In-simulation digitization (PixelDigitizer), only the signals are saved
+		void SetCmdDigitize(G4bool cmd){fCmdDigitize = cmd;}
+		G4bool GetCmdDigitize(){return fCmdDigitize;}
+		void SetDigiThreshold(G4double val){fDigiThreshold = val;}
+		G4double GetDigiThreshold(){return fDigiThreshold;}
+		void SetDigiLatency(G4double val){fDigiLatency = val;}
+		G4double GetDigiLatency(){return fDigiLatency;}
+		void SetDigiSmearing(G4String val){fDigiSmearing = val;}
+		G4String GetDigiSmearing(){return fDigiSmearing;}
+		void SetDigiChannelMap(G4String val){fDigiChannelMap = val;}
+		G4String GetDigiChannelMap(){return fDigiChannelMap;}
+		void SetDigiCFDFraction(G4double val){fDigiCFDFraction = val;}
+		G4double GetDigiCFDFraction(){return fDigiCFDFraction;}
+		// Baseline noise (rms in single cell amplitudes, 0 for none), the
+		// spectrum file replaces the one-pole spectrum of the bandwidth (GHz)
+		void SetDigiNoise(G4double rms){fDigiNoiseRMS = rms;}
+		G4double GetDigiNoise(){return fDigiNoiseRMS;}
+		void SetDigiNoiseBandwidth(G4double val){fDigiNoiseBandwidth = val;}
+		G4double GetDigiNoiseBandwidth(){return fDigiNoiseBandwidth;}
+		void SetDigiNoiseSpectrum(G4String val){fDigiNoiseSpectrum = val;}
+		G4String GetDigiNoiseSpectrum(){return fDigiNoiseSpectrum;}
+		void FillWave(const WaveSignal& signal);
 		
 		void SetCmdPhotons(G4int cmd){fCmdPhotons = cmd;}
 		G4int GetCmdPhotons(){return fCmdPhotons;}
@@ -85,20 +120,26 @@ class RunAction : public G4UserRunAction {
 		void SetCellTime(std::vector<G4double> val){fCellTime = val;}
 		void SetOCTFlag(std::vector<G4int> val){fOCTflag = val;}
 		void SetDNFlag(std::vector<G4int> val){fDNflag = val;}
+		void SetAPFlag(std::vector<G4int> val){fAPflag = val;}
+
+		// Sampling weight of the primary vertex
+		void SetWeight(G4double val){fWeight = val;}
 
 		// Gun time
 		inline void SetGunTimeMean(G4double val){fGunTimeMean = val;}
 		inline G4double GetGunTime(){return fGunTime;}
-		inline void AdvanceGunTime(){fGunTime += G4RandExponential::shoot(fGunTimeMean);}
+		inline void AdvanceGunTime(){fGunTime += BufferedRandom::GetInstance()->Exponential(fGunTimeMean);}
 
 		// Datk noise time
 		inline void SetDNTimeMean(G4double val){fDNTimeMean = val;}
 		inline G4double GetDNTime(){return fDNTime;}
-		inline void AdvanceDNTime(){fDNTime += G4RandExponential::shoot(fDNTimeMean);}
+		inline void AdvanceDNTime(){fDNTime += BufferedRandom::GetInstance()->Exponential(fDNTimeMean);}
 
 	private:
 		TFile* fData;
 		TTree* fTree;
+		TTree* fWaves;
+		WaveWriter* fWaveWriter;
 		// BC400 scorers
 		G4double fEin;
 		G4double fEdep;
@@ -119,7 +160,11 @@ class RunAction : public G4UserRunAction {
 		std::vector<G4double> fTimeGamma;
 		std::vector<G4double> fEGamma;
 
-		G4bool fCmdOCT, fCmdDN;
+		G4bool fCmdOCT, fCmdDN, fCmdAP, fCmdRecovery, fCmdSaturation, fCmdDigitize;
+		G4double fDigiThreshold, fDigiLatency;
+		G4String fDigiSmearing, fDigiChannelMap;
+		G4double fDigiCFDFraction, fDigiNoiseRMS, fDigiNoiseBandwidth;
+		G4String fDigiNoiseSpectrum;
 		G4int fCmdPhotons, fCmdTracks, fNCer;
 		G4int fRight;
 		G4int fLeft;
@@ -136,12 +181,14 @@ class RunAction : public G4UserRunAction {
 		std::vector<G4double> fCellTime;
 		std::vector<G4int> fOCTflag;
 		std::vector<G4int> fDNflag;
+		std::vector<G4int> fAPflag;
 
 		//SiPM time counters
 		G4double fGunTime, fDNTime;
 		G4double fGunTimeMean, fDNTimeMean;
 		
 		G4double fDecayTime;
+		G4double fWeight;
 
 
 		G4String fName;
@@ -12,6 +12,7 @@ class G4UIdirectory;
 class G4UIcmdWithABool;
 class G4UIcmdWithAString;
 class G4UIcmdWithAnInteger;
+class G4UIcmdWithADouble;
 class G4UIcmdWithADoubleAndUnit;
 
 /// it implements command:
@@ -32,6 +33,18 @@ class RunActionMessenger : public G4UImessenger{
 		G4UIcmdWithAString*   fCmdFileName;
 		G4UIcmdWithABool*     fCmdOCT;
 		G4UIcmdWithABool*     fCmdDN;
+		G4UIcmdWithABool*     fCmdAP;
+		G4UIcmdWithABool*     fCmdRecovery;
+		G4UIcmdWithAString*   fCmdResponse;
+		G4UIcmdWithABool*     fCmdDigitize;
+		G4UIcmdWithADouble*   fCmdDigiThreshold;
+		G4UIcmdWithADoubleAndUnit* fCmdDigiLatency;
+		G4UIcmdWithAString*   fCmdDigiSmearing;
+		G4UIcmdWithAString*   fCmdDigiChannelMap;
+		G4UIcmdWithADouble*   fCmdDigiCFDFraction;
+		G4UIcmdWithADouble*   fCmdDigiNoise;
+		G4UIcmdWithADouble*   fCmdDigiNoiseBandwidth;
+		G4UIcmdWithAString*   fCmdDigiNoiseSpectrum;
 		G4UIcmdWithAnInteger* fCmdPhotons;
 		G4UIcmdWithAnInteger* fCmdTracks;
 		G4UIcmdWithADoubleAndUnit* fCmdGunTime;
@@ -0,0 +1,94 @@
+/// \file  SiPMCatalogue.hh
+/// \brief Definition of the SiPMCatalogue class
+
+#ifndef SiPMCatalogue_h
+#define SiPMCatalogue_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/// Characteristics of one SiPM device and its derived tables
+///
+/// The detection efficiency is tabulated on a uniform photon energy grid and
+/// the voltage dependent quantities on a uniform overvoltage grid, so that
+/// every lookup is a single index computation.
+
+struct SiPMDevice{
+	G4String name;
+	G4double pitch;
+	G4int nbPixelsX, nbPixelsY;
+	G4double fillFactor, gain, overVoltage, darkNoiseRate;
+	G4int window; // 0 = Si resin, 1 = Epoxy resin (as in Model arrays)
+	G4double OCTFactor, recoveryTime, afterpulseProb, afterpulseTau;
+	G4String tables[4]; // DetEff, DetEffGain, OCTGain, PhotonGain
+
+	// Derived tables
+	G4double eMin, eStep;
+	std::vector<G4double> detEff;
+	G4double vMin, vStep;
+	std::vector<G4double> detEffGain, OCTGain, photonGain;
+
+	inline G4int GetNbOfPixels() const {return nbPixelsX * nbPixelsY;}
+
+	// Photon energy in eV
+	inline G4double GetDetEff(G4double energy) const {
+		G4int i = G4int((energy - eMin) / eStep + 0.5);
+		if(i < 0 || i >= G4int(detEff.size())) return 0;
+		return detEff[i];
+	}
+
+	// Overvoltage in V
+	inline G4double GetDetEffGain(G4double ov) const {return Lookup(detEffGain, ov);}
+	inline G4double GetOCTGain(G4double ov) const {return Lookup(OCTGain, ov);}
+	inline G4double GetPhotonGain(G4double ov) const {return Lookup(photonGain, ov);}
+
+	private:
+	inline G4double Lookup(const std::vector<G4double>& table, G4double ov) const {
+		G4int i = G4int((ov - vMin) / vStep + 0.5);
+		if(i < 0) i = 0;
+		if(i >= G4int(table.size())) i = table.size() - 1;
+		return table[i];
+	}
+};
+
+/// Catalogue of the SiPM devices
+///
+/// The catalogue is a text file with one device per line. It is parsed once
+/// per process and shared read-only by all threads; the derived tables are
+/// cached in a binary file, <catalogue>.bin in the start up cache directory
+/// (/Element/det/CacheDir) or next to the catalogue, and reused as long as
+/// the catalogue and its tables are unchanged. The tables are recognised by
+/// their size and modification time, so only the catalogue itself is read
+/// when the cache is valid.
+
+class SiPMCatalogue{
+	public:
+		static SiPMCatalogue* GetInstance();
+
+		void Load(G4String fileName);
+		const SiPMDevice* GetDevice(G4String name);
+		std::vector<G4String> GetDeviceNames();
+
+	private:
+		SiPMCatalogue();
+		~SiPMCatalogue();
+
+		void Parse(std::vector<SiPMDevice>& devices);
+		void Derive(SiPMDevice& device);
+		G4bool ReadBinary(G4String name, uint64_t hash);
+		void WriteBinary(G4String name, uint64_t hash);
+		uint64_t Hash(const std::vector<SiPMDevice>& devices);
+		G4String BinaryName();
+
+		G4String fFileName, fDirectory;
+		G4bool fLoaded;
+		std::vector<SiPMDevice> fDevices;
+		std::map<G4String, G4int> fIndex;
+};
+
+#endif
+
+
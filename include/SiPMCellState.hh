@@ -0,0 +1,72 @@
+/// \file  SiPMCellState.hh
+/// \brief Definition of the SiPMCellState class
+
+#ifndef SiPMCellState_h
+#define SiPMCellState_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+/// Per-thread state of the SiPM cells
+///
+/// A bitset tells which cells have fired, the firing time and the OCT child
+/// of each cell are packed together. Only the fired cells are listed, so
+/// resetting the state costs O(fired) instead of O(cells).
+
+class SiPMCellState{
+	public:
+		SiPMCellState();
+		~SiPMCellState();
+
+		void Resize(G4int nCells);
+		void SetRecovery(G4double deadTime, G4double recoveryTime){fDeadTime = deadTime; fRecoveryTime = recoveryTime;}
+
+		inline G4int GetNbOfCells() const {return fNbOfCells;}
+		inline G4double GetDeadTime() const {return fDeadTime;}
+		inline G4bool IsFired(G4int cell) const {return (fFired[cell >> 6] >> (cell & 63)) & 1;}
+		inline G4double GetTime(G4int cell) const {return fCell[cell].time;}
+		inline void SetTime(G4int cell, G4double time){fCell[cell].time = time;}
+		inline G4int GetChild(G4int cell) const {return fCell[cell].child;}
+		inline void SetChild(G4int cell, G4int child){fCell[cell].child = child; fLinked.push_back(cell);}
+
+		// Fraction of the overvoltage recovered at time t (1 for a cell never
+		// fired): 0 during the hold-off (dead time) after the avalanche, then
+		// 1 - exp(-(dt - dead time) / recovery time), continuous at the edge
+		inline G4double GetRecovery(G4int cell, G4double t) const {
+			if(!IsFired(cell)) return 1;
+			G4double dt = t - fCell[cell].time - fDeadTime;
+			if(dt < 0) return 0;
+			if(fRecoveryTime <= 0) return 1;
+			return 1 - std::exp(-dt / fRecoveryTime);
+		}
+
+		inline void Fire(G4int cell, G4double time){
+			if(!IsFired(cell)){
+				fFired[cell >> 6] |= (uint64_t(1) << (cell & 63));
+				fFiredList.push_back(cell);
+			}
+			fCell[cell].time = time;
+		}
+
+		void ClearLinks();
+		void Reset();
+
+	private:
+		struct Cell{
+			G4double time;
+			G4int child;
+		};
+
+		G4int fNbOfCells;
+		G4double fDeadTime, fRecoveryTime;
+		std::vector<uint64_t> fFired;
+		std::vector<Cell> fCell;
+		std::vector<G4int> fFiredList;
+		std::vector<G4int> fLinked;
+};
+
+#endif
+
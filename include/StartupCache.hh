@@ -0,0 +1,59 @@
+/// \file  StartupCache.hh
+/// \brief Definition of the StartupCache class
+
+#ifndef StartupCache_h
+#define StartupCache_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+
+/// Cache of the start up work, shared by the jobs using the same directory
+///
+/// - The overlap check of the placements is done once per geometry: the
+///   verdict is kept in <directory>/overlaps-<hash>, the hash being the one
+///   of the construction parameters (DetectorConstruction::GeometryHash()).
+/// - The physics tables are stored in
+///   <directory>/physics-<Geant4 version>-<physics configuration>-<couples>
+///   after the first run and retrieved by the next runs and jobs; <couples>
+///   is the hash of the materials and production cuts of the volumes, it is
+///   computed again before each run, just before the tables are built.
+/// The files are written aside and renamed into place, so that concurrent
+/// jobs only see complete entries. The cache is disabled until a directory
+/// is given.
+
+class StartupCache{
+	public:
+		static StartupCache* GetInstance();
+
+		void SetDirectory(G4String directory);
+		// Name of the physics list, set by PhysicsList
+		void SetPhysicsConfiguration(G4String val){fPhysicsConfiguration = val;}
+		inline G4bool IsEnabled() const {return fDirectory != "";}
+		inline G4String GetDirectory() const {return fDirectory;}
+
+		// -1: unknown geometry, 0: no overlaps, 1: overlaps
+		G4int GetOverlapVerdict(uint64_t hash);
+		void SetOverlapVerdict(uint64_t hash, G4bool overlaps);
+
+		// Retrieve or build the tables of the current couples, before the
+		// tables are built (master state change to Init)
+		void SelectPhysicsTables();
+		// At the end of the run if the tables have been built
+		void StorePhysicsTables();
+
+	private:
+		StartupCache();
+		~StartupCache();
+
+		G4String OverlapFile(uint64_t hash);
+		uint64_t CouplesHash();
+
+		G4String fDirectory, fPhysicsDirectory, fPhysicsConfiguration;
+		G4bool fStorePhysics;
+		G4bool fNotifier;
+};
+
+#endif
+
+
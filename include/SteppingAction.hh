@@ -0,0 +1,43 @@
+/// \file  SteppingAction.hh
+/// \brief Definition of the SteppingAction class
+
+#ifndef SteppingAction_h
+#define SteppingAction_h 1
+
+#include "G4UserSteppingAction.hh"
+#include "globals.hh"
+
+#include <vector>
+#include <map>
+
+class G4Region;
+
+/// Number of steps in each region (DetectorConstruction::SetRegionCut)
+///
+/// The steps are counted per thread, added to the total of the run by
+/// EndOfRun() and printed by the master with PrintRegionSteps().
+
+class SteppingAction : public G4UserSteppingAction{
+	public:
+		SteppingAction();
+		virtual ~SteppingAction();
+
+		virtual void UserSteppingAction(const G4Step*);
+
+		void EndOfRun();
+		static void PrintRegionSteps();
+
+	private:
+		struct Count{
+			const G4Region* region;
+			G4long steps;
+		};
+		std::vector<Count> fCounts;
+		size_t fLast;
+
+		static std::map<G4String, G4long> fRunSteps;
+};
+
+#endif
+
+
@@ -0,0 +1,42 @@
+/// \file  SweepMessenger.hh
+/// \brief Definition of the SweepMessenger class
+
+#ifndef SweepMessenger_h
+#define SweepMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class ParameterSweep;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+
+/// it implements command:
+/// - /Element/sweep/add name value...
+/// - /Element/sweep/list file
+/// - /Element/sweep/clear
+/// - /Element/sweep/run events [prefix]
+
+class SweepMessenger : public G4UImessenger{
+	public:
+		SweepMessenger(ParameterSweep*);
+		virtual ~SweepMessenger();
+
+		virtual void SetNewValue(G4UIcommand*, G4String);
+
+	private:
+		ParameterSweep* fSweep;
+
+		G4UIdirectory* fSweepDirectory;
+
+		G4UIcmdWithAString* fCmdAdd;
+		G4UIcmdWithAString* fCmdList;
+		G4UIcmdWithoutParameter* fCmdClear;
+		G4UIcommand* fCmdRun;
+};
+
+#endif
+
+
@@ -5,6 +5,7 @@
 #include "RunAction.hh"
 #include "EventAction.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "SteppingAction.hh"
 
 ActionInitialization::ActionInitialization() : G4VUserActionInitialization(){}
 
@@ -20,6 +21,7 @@ void ActionInitialization::Build() const{
 
     SetUserAction(new EventAction(runAction));
     SetUserAction(new PrimaryGeneratorAction);
+    SetUserAction(new SteppingAction);
 }
 
 
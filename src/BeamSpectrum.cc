@@ -0,0 +1,172 @@
+/// \file  BeamSpectrum.cc
+/// \brief Implementation of the BeamSpectrum class
+
+#include "BeamSpectrum.hh"
+
+#include "G4Exception.hh"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+
+BeamSpectrum::BeamSpectrum(){}
+
+BeamSpectrum::~BeamSpectrum(){}
+
+G4bool BeamSpectrum::Load(G4String fileName, G4int dimension){
+	std::ifstream myfile(fileName);
+	if(!myfile.is_open()){
+		G4Exception("BeamSpectrum::Load", "Beam001", JustWarning, ("Cannot open " + fileName).c_str());
+		return false;
+	}
+	// (x, y) -> density, sampling
+	std::map<std::pair<G4double, G4double>, std::pair<G4double, G4double>> points;
+	G4int nColumns = 0;
+	std::string line;
+	while(std::getline(myfile, line)){
+		if(line.empty() || line[0] == '#') continue;
+		std::istringstream is(line);
+		std::vector<G4double> values;
+		G4double val;
+		while(is >> val) values.push_back(val);
+		if(values.empty()) continue;
+		if(nColumns == 0) nColumns = values.size();
+		if(G4int(values.size()) != nColumns || nColumns < dimension + 1 || nColumns > dimension + 2){
+			G4Exception("BeamSpectrum::Load", "Beam002", JustWarning, ("Malformed line in " + fileName + ": " + line).c_str());
+			return false;
+		}
+		G4double x = values[0], y = (dimension == 2) ? values[1] : 0;
+		G4double density = values[dimension];
+		points[std::make_pair(x, y)] = std::make_pair(density, nColumns == dimension + 2 ? values[dimension + 1] : density);
+	}
+
+	std::vector<G4double> xs, ys;
+	for(auto& point : points){
+		xs.push_back(point.first.first);
+		ys.push_back(point.first.second);
+	}
+	std::sort(ys.begin(), ys.end());
+	xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+	ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+	if(xs.empty() || xs.size() * ys.size() != points.size()){
+		G4Exception("BeamSpectrum::Load", "Beam003", JustWarning, (fileName + " is not a regular grid").c_str());
+		return false;
+	}
+
+	Edges(xs, fX);
+	if(dimension == 2) Edges(ys, fY);
+	else fY.clear();
+	std::vector<G4double> density, sampling;
+	for(auto& point : points){
+		density.push_back(point.second.first);
+		sampling.push_back(point.second.second);
+	}
+	Build(density, nColumns == dimension + 2 ? sampling : std::vector<G4double>());
+	if(fBins.empty()){
+		G4Exception("BeamSpectrum::Load", "Beam004", JustWarning, ("Null distribution in " + fileName).c_str());
+		return false;
+	}
+	return true;
+}
+
+void BeamSpectrum::Tabulate(std::function<G4double(G4double)> density, G4double xMin, G4double xMax, G4int nBins){
+	fX.resize(nBins + 1);
+	fY.clear();
+	std::vector<G4double> w(nBins);
+	for(G4int i = 0; i <= nBins; i++) fX[i] = xMin + (xMax - xMin) * i / nBins;
+	for(G4int i = 0; i < nBins; i++) w[i] = density(0.5 * (fX[i] + fX[i + 1]));
+	Build(w, std::vector<G4double>());
+}
+
+void BeamSpectrum::Michel(){
+	const G4double Emax = 52.83; // MeV, half the muon mass
+	Tabulate([Emax](G4double E){
+		G4double x = E / Emax;
+		return x * x * (3 - 2 * x);
+	}, 0, Emax, 1000);
+}
+
+/// Bins bounded by the midpoints between the points, the outer bins stop
+/// at the first and last points (half bins): the values never leave the
+/// tabulated range (e.g. no negative energy for a table starting at 0)
+void BeamSpectrum::Edges(const std::vector<G4double>& centres, std::vector<G4double>& edges){
+	size_t n = centres.size();
+	edges.resize(n + 1);
+	if(n == 1){
+		edges[0] = edges[1] = centres[0];
+		return;
+	}
+	for(size_t i = 1; i < n; i++) edges[i] = 0.5 * (centres[i - 1] + centres[i]);
+	edges[0] = centres[0];
+	edges[n] = centres[n - 1];
+}
+
+/// Bin probabilities (value times bin size), weights and alias table
+void BeamSpectrum::Build(std::vector<G4double> density, std::vector<G4double> sampling){
+	G4int nx = fX.size() - 1, ny = fY.empty() ? 1 : fY.size() - 1;
+	G4int n = nx * ny;
+	G4bool biased = !sampling.empty();
+	if(!biased) sampling = density;
+	G4double sumP = 0, sumQ = 0;
+	for(G4int k = 0; k < n; k++){
+		G4double size = (fX[k / ny + 1] - fX[k / ny]) * (fY.empty() ? 1 : fY[k % ny + 1] - fY[k % ny]);
+		// a single point is a bin of its own
+		if(!(size > 0)) size = 1;
+		density[k] = (density[k] > 0) ? density[k] * size : 0;
+		sampling[k] = (sampling[k] > 0) ? sampling[k] * size : 0;
+		sumP += density[k];
+		sumQ += sampling[k];
+	}
+	fBins.clear();
+	fWeight.assign(n, 1);
+	if(!(sumP > 0) || !(sumQ > 0)) return;
+	if(biased){
+		for(G4int k = 0; k < n; k++) fWeight[k] = (sampling[k] > 0) ? (density[k] / sumP) / (sampling[k] / sumQ) : 0;
+	}
+
+	// Walker alias table (Vose's construction)
+	fBins.resize(n);
+	std::vector<G4double> p(n);
+	std::vector<G4int> small, large;
+	for(G4int k = 0; k < n; k++){
+		p[k] = sampling[k] * n / sumQ;
+		if(p[k] < 1) small.push_back(k);
+		else large.push_back(k);
+	}
+	while(!small.empty() && !large.empty()){
+		G4int s = small.back(), l = large.back();
+		small.pop_back();
+		fBins[s] = Bin{p[s], l};
+		p[l] -= 1 - p[s];
+		if(p[l] < 1){
+			large.pop_back();
+			small.push_back(l);
+		}
+	}
+	for(G4int k : large) fBins[k] = Bin{1, k};
+	for(G4int k : small) fBins[k] = Bin{1, k};
+}
+
+G4double BeamSpectrum::Sample(G4double u, G4double v, G4double& x, G4double& y) const {
+	G4int n = fBins.size();
+	G4double t = u * n;
+	G4int i = G4int(t);
+	if(i >= n) i = n - 1;
+	G4double frac = t - i, r;
+	const Bin& bin = fBins[i];
+	G4int k;
+	if(frac < bin.prob){
+		k = i;
+		r = frac / bin.prob;
+	}
+	else{
+		k = bin.alias;
+		r = (frac - bin.prob) / (1 - bin.prob);
+	}
+	G4int ny = fY.empty() ? 1 : fY.size() - 1;
+	G4int ix = k / ny, iy = k % ny;
+	x = fX[ix] + r * (fX[ix + 1] - fX[ix]);
+	y = fY.empty() ? 0 : fY[iy] + v * (fY[iy + 1] - fY[iy]);
+	return fWeight[k];
+}
@@ -0,0 +1,41 @@
+/// \file  BufferedRandom.cc
+/// \brief Implementation of the BufferedRandom class
+
+#include "BufferedRandom.hh"
+
+#include "Randomize.hh"
+#include "G4AutoDelete.hh"
+
+#include <cmath>
+#include <algorithm>
+
+G4ThreadLocal BufferedRandom* BufferedRandom::fInstance = nullptr;
+
+BufferedRandom::BufferedRandom(){
+	Reset();
+}
+
+BufferedRandom* BufferedRandom::GetInstance(){
+	if(!fInstance){
+		fInstance = new BufferedRandom();
+		G4AutoDelete::Register(fInstance);
+	}
+	return fInstance;
+}
+
+void BufferedRandom::FillFlat(){
+	fFlatSize = fFlatNext;
+	G4Random::getTheEngine()->flatArray(fFlatSize, fFlat);
+	fFlatIndex = 0;
+	fFlatNext = std::min(2 * fFlatNext, G4int(kBlockSize));
+}
+
+void BufferedRandom::FillExponential(){
+	fExpSize = fExpNext;
+	G4Random::getTheEngine()->flatArray(fExpSize, fExp);
+	for(G4int i = 0; i < fExpSize; i++) fExp[i] = - std::log(fExp[i]);
+	fExpIndex = 0;
+	fExpNext = std::min(2 * fExpNext, G4int(kBlockSize));
+}
+
+
@@ -5,6 +5,8 @@
 #include "DetectorMessenger.hh"
 #include "RunAction.hh"
 #include "SiPMModel.hh"
+#include "SiPMCatalogue.hh"
+#include "StartupCache.hh"
 
 
 #include "G4Material.hh"
@@ -18,6 +20,9 @@
 #include "G4Box.hh"
 #include "G4SubtractionSolid.hh"
 #include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
 #include "G4PVPlacement.hh"
 #include "G4PVReplica.hh"
 #include "G4GlobalMagFieldMessenger.hh"
@@ -46,18 +51,33 @@
 
 #include <G4UserLimits.hh>
 
+#include <set>
+
+namespace {
+	uint64_t FNV1a(uint64_t hash, const void* data, size_t n){
+		for(size_t i = 0; i < n; i++){
+			hash ^= ((const unsigned char*) data)[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+std::atomic<G4int> DetectorConstruction::fGeometryVersion(0);
+
 /// Constructor
 DetectorConstruction::DetectorConstruction() : 
 	G4VUserDetectorConstruction(), fmodel("75PE"), fCrysVolume(nullptr), 
 	fSiPMVolume(nullptr), fElementVolume(nullptr), fSolidCrys(nullptr), 
 	fSolidWorld(nullptr), fSolidElement(nullptr), fCheckOverlaps(true), 
-	fNbOfPixelsX(0), fNbOfPixelsY(0), fLogicPixel(nullptr), fLogicCrys(nullptr), 
+	fVirtualPixels(false), fDeferChanges(false), fRebuildPending(false), fModifiedPending(false), fNbOfPixelsX(0), fNbOfPixelsY(0), fLogicPixel(nullptr), fLogicCrys(nullptr), 
 	fCrysSizeX(2*mm), fCrysSizeY(2*mm), fCrysSizeZ(2*mm), fSiPM_sizeXY(1.3*mm), 
 	fSiPM_sizeZ(0*mm), fGround(1), fAngle(0), fAngleWithOpticalGrease(0), fTilt(0)
 {
 	fDetectorMessenger = new DetectorMessenger(this);
 	SetSiPMmodel("75PE");
 	DefineMaterials();
+	DefineRegions();
 	fMaterial = fBC400;
 	fMaterialWindow = fEpResin;
 }
@@ -299,36 +319,47 @@ void DetectorConstruction::DefineMaterials(){
 void DetectorConstruction::SetCrystalMaterial(G4String name){
 	if(name == "BC400") fMaterial = fBC400;
 	else if(name == "LYSO") fMaterial = fLYSO;
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
 }
 
 void DetectorConstruction::SetSiPMmodel(G4String name){
-	G4int i = 0, j = 0; //i is for the pitch, j is for the window material;
-	if (name == "75PE") {i = 0; j = 1;}
-	else if (name == "50PE") {i = 1; j = 1;}
-	else if (name == "25PE") {i = 2; j = 1;}
-	else if (name == "75CS") {i = 0; j = 0;}
-	else if (name == "50CS") {i = 1; j = 0;}
-	else if (name == "25CS") {i = 2; j = 0;};
+	const SiPMDevice* device = SiPMCatalogue::GetInstance()->GetDevice(name);
+	if(!device){
+		G4Exception("DetectorConstruction::SetSiPMmodel", "SiPM003", JustWarning, ("Unknown SiPM model " + name + ", keeping " + fmodel).c_str());
+		return;
+	}
+	G4int j = device->window; //j is for the window material;
 	
 	fmodel = name;
 	if(j == 1) fMaterialWindow = fEpResin;
 	else if(j == 0) fMaterialWindow = fSiResin;
 
-	fNbOfPixelsX = Model::NbPixelsX[i];
-	fNbOfPixelsY = Model::NbPixelsY[i];
+	fNbOfPixelsX = device->nbPixelsX;
+	fNbOfPixelsY = device->nbPixelsY;
 	
 	fSiPM_sizeZ = Model::SiPM_size_Z[j];
 	fSiPM_windowZ = Model::window_size_Z[j];
 
 	if(G4RunManager::GetRunManager()->GetUserRunAction()){
-		((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->SetDNTimeMean(1 / Model::dark_noise_rate[i]);
+		((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->SetDNTimeMean(1 / device->darkNoiseRate);
 	}
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
+}
+
+void DetectorConstruction::SetSiPMCatalogue(G4String name){
+	SiPMCatalogue::GetInstance()->Load(name);
+	SetSiPMmodel(fmodel);
 }
 
 G4VPhysicalVolume* DetectorConstruction::DefineVolumes(){
 
+    // With a start up cache the overlaps are checked once per geometry,
+    // after the construction, instead of at every placement
+    StartupCache* cache = StartupCache::GetInstance();
+    uint64_t hash = GeometryHash();
+    G4int verdict = cache->GetOverlapVerdict(hash);
+    fCheckOverlaps = !cache->IsEnabled();
+
     /// MATERIALS AND PARAMETERS
 	
     // Crystal parameters
@@ -357,12 +388,6 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes(){
     G4LogicalVolume* logicCrys = new G4LogicalVolume(fSolidCrys, fMaterial, "CrysLV");
     fLogicCrys = logicCrys;    
 	
-	//SetUserMinRange
-G4UserLimits *limits = new G4UserLimits ();
-limits->SetMaxAllowedStep(2*mm);
-fLogicCrys->SetUserLimits(limits);
-
-	
 	// SiPM
     G4Box* solidSiPM = new G4Box("SiPM", 0.5*SiPM_sizeXY, 0.5*SiPM_sizeXY, 0.5*(SiPM_sizeZ + fSiPM_windowZ));
     G4LogicalVolume* logicSiPM = new G4LogicalVolume(solidSiPM, fVacuum, "SiPM");
@@ -372,17 +397,27 @@ fLogicCrys->SetUserLimits(limits);
     G4LogicalVolume* logicSiPMwindow = new G4LogicalVolume(solidSiPMwindow, fMaterialWindow, "SiPMwindow");
     
     // SiPM pixel
-    G4Box* solidPixel = new G4Box("Pixel", 0.5*SiPM_sizeXY / fNbOfPixelsX, 0.5*SiPM_sizeXY / fNbOfPixelsY, 0.5*SiPM_sizeZ);
-    G4LogicalVolume* logicPixel = new G4LogicalVolume(solidPixel, fSi, "PixelLV");
-    G4int i = 0, j = 0;
-    fLogicPixel = logicPixel;
-
-    for(G4int ipixel = 0; ipixel < nofPixels; ++ipixel){
-        i = ipixel%int(fNbOfPixelsX);
-        j = ipixel/int(fNbOfPixelsX);
-        G4ThreeVector pixel_pos = G4ThreeVector(SiPM_sizeXY /fNbOfPixelsX * (-0.5 * fNbOfPixelsX + i + 0.5), SiPM_sizeXY /fNbOfPixelsY * (-0.5 * fNbOfPixelsY + j + 0.5), -0.5 * (fSiPM_windowZ));
-        new G4PVPlacement(0, pixel_pos, logicPixel, "Pixel", logicSiPM, false, ipixel, fCheckOverlaps);
+    // With virtual pixels the whole active silicon is a single volume and
+    // PixelSD computes the pixel index from the local hit position
+    G4LogicalVolume* logicPixel = nullptr;
+    if(fVirtualPixels){
+        G4Box* solidPixel = new G4Box("Pixel", 0.5*SiPM_sizeXY, 0.5*SiPM_sizeXY, 0.5*SiPM_sizeZ);
+        logicPixel = new G4LogicalVolume(solidPixel, fSi, "PixelLV");
+        new G4PVPlacement(0, G4ThreeVector(0, 0, -0.5 * (fSiPM_windowZ)), logicPixel, "Pixel", logicSiPM, false, 0, fCheckOverlaps);
+    }
+    else{
+        G4Box* solidPixel = new G4Box("Pixel", 0.5*SiPM_sizeXY / fNbOfPixelsX, 0.5*SiPM_sizeXY / fNbOfPixelsY, 0.5*SiPM_sizeZ);
+        logicPixel = new G4LogicalVolume(solidPixel, fSi, "PixelLV");
+        G4int i = 0, j = 0;
+
+        for(G4int ipixel = 0; ipixel < nofPixels; ++ipixel){
+            i = ipixel%int(fNbOfPixelsX);
+            j = ipixel/int(fNbOfPixelsX);
+            G4ThreeVector pixel_pos = G4ThreeVector(SiPM_sizeXY /fNbOfPixelsX * (-0.5 * fNbOfPixelsX + i + 0.5), SiPM_sizeXY /fNbOfPixelsY * (-0.5 * fNbOfPixelsY + j + 0.5), -0.5 * (fSiPM_windowZ));
+            new G4PVPlacement(0, pixel_pos, logicPixel, "Pixel", logicSiPM, false, ipixel, fCheckOverlaps);
+        }
     }
+    fLogicPixel = logicPixel;
 
     new G4PVPlacement(0, G4ThreeVector(0, 0, 0.5 * SiPM_sizeZ), logicSiPMwindow, "Window", logicSiPM, false, 0, fCheckOverlaps);
 
@@ -432,6 +467,12 @@ fLogicCrys->SetUserLimits(limits);
     //Place Element in World
     G4ThreeVector element_pos = G4ThreeVector(0, 0, - (fSolidWorld->GetZHalfLength() - fSolidElement->GetZHalfLength()) + 0.1 * mm);
     fElementVolume = new G4PVPlacement(0, element_pos, logicElement, "Element", logicWorld, false, 0, fCheckOverlaps);
+
+    // Regions, the world is left in the default region
+    SetRegionRoot("Crystal", logicCrys);
+    SetRegionRoot("SiPM", logicSiPM);
+    SetRegionRoot("Transport", logicElement);
+    for(auto& region : fRegions) SetRegionLimits(region.second.root, region.second.limits);
     
     // Scintillator glisur
     if(fGround < 1){
@@ -451,10 +492,78 @@ fLogicCrys->SetUserLimits(limits);
     logicPixel->SetVisAttributes(G4Colour(0.,0.,1., 0.8));
     logicWorld->SetVisAttributes(G4Colour(1, 1, 1, 0.1));
     logicCrys->SetVisAttributes(G4Colour(1, 1, 1, 0.3));
+
+    if(cache->IsEnabled()){
+        if(verdict < 0){
+            std::set<G4LogicalVolume*> checked;
+            verdict = CheckOverlaps(logicWorld, checked) ? 1 : 0;
+            cache->SetOverlapVerdict(hash, verdict == 1);
+        }
+        else G4cout << "StartupCache: overlap check skipped (cached)" << G4endl;
+        if(verdict == 1) G4Exception("DetectorConstruction::DefineVolumes", "Geom001", JustWarning, "The geometry has overlapping volumes");
+    }
     
+    fGeometryVersion++;
     return physWorld;
 }
 
+/// Regions with the default cuts, a step limit of 2 mm in the crystal
+void DetectorConstruction::DefineRegions(){
+	for(G4String name : {"Crystal", "SiPM", "Transport"}){
+		RegionSettings& settings = fRegions[name];
+		settings.region = new G4Region(name);
+		settings.cuts = new G4ProductionCuts();
+		settings.defaultCuts = true;
+		settings.limits = new G4UserLimits();
+		settings.root = nullptr;
+		settings.region->SetUserLimits(settings.limits);
+	}
+	fRegions["Crystal"].limits->SetMaxAllowedStep(2*mm);
+}
+
+void DetectorConstruction::SetRegionRoot(G4String name, G4LogicalVolume* volume){
+	RegionSettings& settings = fRegions[name];
+	// the volumes of the previous construction stay in the stores
+	if(settings.root) settings.region->RemoveRootLogicalVolume(settings.root);
+	settings.region->AddRootLogicalVolume(volume);
+	settings.region->SetProductionCuts(settings.defaultCuts ? G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts() : settings.cuts);
+	settings.root = volume;
+}
+
+/// The limits of volume and of its daughters but the roots of other regions
+void DetectorConstruction::SetRegionLimits(G4LogicalVolume* volume, G4UserLimits* limits){
+	volume->SetUserLimits(limits);
+	for(size_t i = 0; i < volume->GetNoDaughters(); i++){
+		G4LogicalVolume* daughter = volume->GetDaughter(i)->GetLogicalVolume();
+		if(!daughter->IsRootRegion() && daughter->GetUserLimits() != limits) SetRegionLimits(daughter, limits);
+	}
+}
+
+/// Hash of everything the placements depend on
+uint64_t DetectorConstruction::GeometryHash(){
+	G4double values[] = {fCrysSizeX, fCrysSizeY, fCrysSizeZ, fSiPM_sizeXY, fSiPM_sizeZ, fSiPM_windowZ,
+			     G4double(fNbOfPixelsX), G4double(fNbOfPixelsY), G4double(fVirtualPixels),
+			     fGround, fAngle, fAngleWithOpticalGrease, fTilt};
+	uint64_t hash = FNV1a(14695981039346656037ULL, values, sizeof(values));
+	for(const G4String& name : {fmodel, fMaterial->GetName(), fMaterialWindow->GetName()}){
+		hash = FNV1a(hash, name.data(), name.size() + 1);
+	}
+	return hash;
+}
+
+/// Overlaps of the daughters of volume and, once per logical volume, of
+/// their own daughters
+G4bool DetectorConstruction::CheckOverlaps(G4LogicalVolume* volume, std::set<G4LogicalVolume*>& checked){
+	G4bool overlaps = false;
+	if(!checked.insert(volume).second) return overlaps;
+	for(size_t i = 0; i < volume->GetNoDaughters(); i++){
+		G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+		overlaps |= daughter->CheckOverlaps();
+		overlaps |= CheckOverlaps(daughter->GetLogicalVolume(), checked);
+	}
+	return overlaps;
+}
+
 void DetectorConstruction::ConstructSDandField(){
 	if(!fScint_SD.Get()){
 		G4cout << "Construction /Det/ScintSD" << G4endl;
@@ -468,12 +577,14 @@ void DetectorConstruction::ConstructSDandField(){
 		G4cout << "Contruction /Det/PixelSD" << G4endl;
 		PixelSD* pixel_SD = new PixelSD("Det/PixelSD", fmodel);
 		pixel_SD->SetModel(fmodel);
+		pixel_SD->SetVirtualPixels(fVirtualPixels);
 		pixel_SD->DefineProperties();
 		fPixel_SD.Put(pixel_SD);
 	}
 	else{
 		PixelSD* pixel_SD = fPixel_SD.Get();
 		pixel_SD->SetModel(fmodel);
+		pixel_SD->SetVirtualPixels(fVirtualPixels);
 		pixel_SD->DefineProperties();
 	}
 	G4SDManager::GetSDMpointer()->AddNewDetector(fPixel_SD.Get());
@@ -501,7 +612,8 @@ void DetectorConstruction :: SetCrystalSize(G4double size){
 	fCrysVolume->SetTranslation(G4ThreeVector(0, 0, 0.5 * SiPM_sizeZ));
 	fSiPMVolume->SetTranslation(G4ThreeVector(0, 0, -0.5 * (size)));
 	fElementVolume->SetTranslation(G4ThreeVector(0, 0, -0.5 * (fSolidWorld->GetZHalfLength() - fSolidElement->GetZHalfLength())));
-	G4RunManager::GetRunManager()->GeometryHasBeenModified();
+	fGeometryVersion++;
+	GeometryModified();
 }
 
 void DetectorConstruction :: SetCrystalSize(G4ThreeVector size){
@@ -525,29 +637,81 @@ void DetectorConstruction :: SetCrystalSize(G4ThreeVector size){
 	fCrysVolume->SetTranslation(G4ThreeVector(0, 0, 0.5 * SiPM_sizeZ));
 	fSiPMVolume->SetTranslation(G4ThreeVector(0, 0, -0.5 * (size.getZ())));
 	fElementVolume->SetTranslation(G4ThreeVector(0, 0, 0));
-	G4RunManager::GetRunManager()->GeometryHasBeenModified();
+	fGeometryVersion++;
+	GeometryModified();
 }
 
 void DetectorConstruction  :: SetGround(G4double val){
 	fGround = val;
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
 }
 
 void DetectorConstruction :: SetAngle(G4double val){
 	fAngle = val;
 	fAngleWithOpticalGrease = 0;
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
 }
 
 void DetectorConstruction :: SetAngleWithOpticalGrease(G4double val){
 	fAngle = 0;
 	fAngleWithOpticalGrease = val;
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
 }
 
 void DetectorConstruction :: SetTilt(G4double val){
 	fTilt = val;
-	G4RunManager::GetRunManager()->ReinitializeGeometry();
+	RebuildGeometry();
 }
 
+void DetectorConstruction :: SetVirtualPixels(G4bool val){
+	fVirtualPixels = val;
+	RebuildGeometry();
+}
 
+/// Production cut of every particle in region, applied at the next run
+void DetectorConstruction::SetRegionCut(G4String name, G4double val){
+	auto it = fRegions.find(name);
+	if(it == fRegions.end()){
+		G4Exception("DetectorConstruction::SetRegionCut", "Geom002", JustWarning, ("Unknown region " + name).c_str());
+		return;
+	}
+	RegionSettings& settings = it->second;
+	// the cuts object is reused: the couples of the previous runs point to it
+	settings.defaultCuts = !(val > 0);
+	if(val > 0) settings.cuts->SetProductionCut(val);
+	if(settings.root) settings.region->SetProductionCuts(settings.defaultCuts ? G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts() : settings.cuts);
+}
+
+/// The limits are shared by the volumes of the region, no rebuild needed
+void DetectorConstruction::SetRegionStepLimit(G4String name, G4double val){
+	auto it = fRegions.find(name);
+	if(it == fRegions.end()){
+		G4Exception("DetectorConstruction::SetRegionStepLimit", "Geom002", JustWarning, ("Unknown region " + name).c_str());
+		return;
+	}
+	it->second.limits->SetMaxAllowedStep(val > 0 ? val : DBL_MAX);
+}
+
+void DetectorConstruction::BeginChanges(){
+	fDeferChanges = true;
+}
+
+/// Apply the changes made since BeginChanges()
+void DetectorConstruction::CommitChanges(){
+	fDeferChanges = false;
+	if(fRebuildPending) G4RunManager::GetRunManager()->ReinitializeGeometry();
+	else if(fModifiedPending) G4RunManager::GetRunManager()->GeometryHasBeenModified();
+	fRebuildPending = false;
+	fModifiedPending = false;
+}
+
+void DetectorConstruction::RebuildGeometry(){
+	if(fDeferChanges) fRebuildPending = true;
+	else G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+/// The volumes have been modified in place
+void DetectorConstruction::GeometryModified(){
+	if(fDeferChanges) fModifiedPending = true;
+	else G4RunManager::GetRunManager()->GeometryHasBeenModified();
+}
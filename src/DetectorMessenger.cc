@@ -3,12 +3,19 @@
 
 #include "DetectorMessenger.hh"
 #include "DetectorConstruction.hh"
+#include "StartupCache.hh"
 
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithADouble.hh"
 #include "G4UIcmdWith3VectorAndUnit.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
 
 
 DetectorMessenger::DetectorMessenger(DetectorConstruction* Det) : G4UImessenger(), fDetectorConstruction(Det){
@@ -54,17 +61,61 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* Det) : G4UImessenger(
 	fTilt->AvailableForStates(G4State_Idle);
 	
 	fSiPMmodelCmd = new G4UIcmdWithAString("/Element/det/SiPMmodel", this);
-	fSiPMmodelCmd->SetGuidance("Set SiPM model");
+	fSiPMmodelCmd->SetGuidance("Set SiPM model, any device of the SiPM catalogue (e.g. 75PE, 50PE, 25PE, 75CS, 50CS, 25CS)");
 	fSiPMmodelCmd->SetParameterName("model", false);
-	fSiPMmodelCmd->SetCandidates("75PE || 50PE || 25PE || 75CS || 50CS || 25CS");
 	fSiPMmodelCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 
+	fSiPMCatalogueCmd = new G4UIcmdWithAString("/Element/det/SiPMCatalogue", this);
+	fSiPMCatalogueCmd->SetGuidance("Load the SiPM models from a catalogue file (default ../tables/SiPM_models.txt)");
+	fSiPMCatalogueCmd->SetParameterName("catalogue", false);
+	fSiPMCatalogueCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+	fVirtualPixelsCmd = new G4UIcmdWithABool("/Element/det/VirtualPixels", this);
+	fVirtualPixelsCmd->SetGuidance("Use a single sensitive volume for the SiPM and compute the pixel from the hit position");
+	fVirtualPixelsCmd->SetParameterName("VirtualPixels", false);
+	fVirtualPixelsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
 	fCrysMaterialCmd = new G4UIcmdWithAString("/Element/det/CrysMaterial", this);
 	fCrysMaterialCmd->SetGuidance("Set scintillating material");
 	fCrysMaterialCmd->SetParameterName("material", false);
 	fCrysMaterialCmd->SetCandidates("BC400 || LYSO");
 	fCrysMaterialCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 
+	fBeginCmd = new G4UIcmdWithoutParameter("/Element/det/begin", this);
+	fBeginCmd->SetGuidance("Start a group of detector changes, the geometry is rebuilt once at /Element/det/commit");
+	fBeginCmd->SetGuidance("A run started before the commit is aborted");
+	fBeginCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+	fCommitCmd = new G4UIcmdWithoutParameter("/Element/det/commit", this);
+	fCommitCmd->SetGuidance("Apply the detector changes made since /Element/det/begin");
+	fCommitCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+	fCacheDirCmd = new G4UIcmdWithAString("/Element/det/CacheDir", this);
+	fCacheDirCmd->SetGuidance("Keep the overlap check verdicts and the physics tables in a directory shared by the jobs (none to disable)");
+	fCacheDirCmd->SetGuidance("The physics tables are chosen before each run from the materials and production cuts of the volumes");
+	fCacheDirCmd->SetParameterName("directory", false);
+	fCacheDirCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+	fCacheDirCmd->SetToBeBroadcasted(false);
+
+	fRegionCutCmd = new G4UIcommand("/Element/det/RegionCut", this);
+	fRegionCutCmd->SetGuidance("Set the production cut of all particles in a region (0 for the default cut)");
+	fRegionCutCmd->SetGuidance("Crystal, SiPM (window and pixels) or Transport (the rest of the element)");
+	fRegionStepLimitCmd = new G4UIcommand("/Element/det/RegionStepLimit", this);
+	fRegionStepLimitCmd->SetGuidance("Set the maximum step in a region (0 for no limit, default 2 mm in the crystal)");
+	fRegionStepLimitCmd->SetGuidance("Crystal, SiPM (window and pixels) or Transport (the rest of the element)");
+	for(G4UIcommand* command : {fRegionCutCmd, fRegionStepLimitCmd}){
+		G4UIparameter* region = new G4UIparameter("region", 's', false);
+		region->SetParameterCandidates("Crystal SiPM Transport");
+		command->SetParameter(region);
+		G4UIparameter* value = new G4UIparameter("value", 'd', false);
+		value->SetParameterRange("value >= 0");
+		command->SetParameter(value);
+		G4UIparameter* unit = new G4UIparameter("unit", 's', true);
+		unit->SetDefaultValue("mm");
+		command->SetParameter(unit);
+		command->AvailableForStates(G4State_PreInit,G4State_Idle);
+	}
+
 }
 
 DetectorMessenger::~DetectorMessenger(){
@@ -75,7 +126,14 @@ DetectorMessenger::~DetectorMessenger(){
 	delete fAngleWithOpticalGrease;
 	delete fTilt;
 	delete fSiPMmodelCmd;
+	delete fSiPMCatalogueCmd;
+	delete fVirtualPixelsCmd;
 	delete fCrysMaterialCmd;
+	delete fBeginCmd;
+	delete fCommitCmd;
+	delete fCacheDirCmd;
+	delete fRegionCutCmd;
+	delete fRegionStepLimitCmd;
 	delete fDetDirectory;
 	delete fElementDirectory;
 }
@@ -120,9 +178,39 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
 		fDetectorConstruction->SetSiPMmodel(newValue);
 	}
 
+	else if(command == fSiPMCatalogueCmd){
+		fDetectorConstruction->SetSiPMCatalogue(newValue);
+	}
+
+	else if(command == fVirtualPixelsCmd){
+		fDetectorConstruction->SetVirtualPixels(fVirtualPixelsCmd->GetNewBoolValue(newValue));
+	}
+
 	else if(command == fCrysMaterialCmd){
 		fDetectorConstruction->SetCrystalMaterial(newValue);
 	}
+
+	else if(command == fBeginCmd){
+		fDetectorConstruction->BeginChanges();
+	}
+
+	else if(command == fCommitCmd){
+		fDetectorConstruction->CommitChanges();
+	}
+
+	else if(command == fCacheDirCmd){
+		StartupCache::GetInstance()->SetDirectory(newValue == "none" ? "" : newValue);
+	}
+
+	else if(command == fRegionCutCmd || command == fRegionStepLimitCmd){
+		std::istringstream is(newValue);
+		G4String region, unit;
+		G4double value;
+		is >> region >> value >> unit;
+		value *= G4UIcommand::ValueOf(unit);
+		if(command == fRegionCutCmd) fDetectorConstruction->SetRegionCut(region, value);
+		else fDetectorConstruction->SetRegionStepLimit(region, value);
+	}
 }
 
 
@@ -7,11 +7,14 @@
 #include "EventAction.hh"
 #include "ScintHit.hh"
 #include "PixelHit.hh"
+#include "PixelDigi.hh"
+#include "PixelDigitizer.hh"
 
 #include "G4RunManager.hh"
 #include "G4Event.hh"
 
 #include "G4SDManager.hh"
+#include "G4DigiManager.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4UnitsTable.hh"
 #include "G4THitsMap.hh"
@@ -19,13 +22,18 @@
 
 EventAction::EventAction(RunAction* runAction) : 
 	G4UserEventAction(), fRunAction(runAction), fCollIDScint(-1), 
-	fCollIDSiPM(-1), fCollIDSiPMDraw(-1), fEvID(-1){}
+	fCollIDSiPM(-1), fCollIDSiPMDraw(-1), fEvID(-1){
+	G4DigiManager::GetDMpointer()->AddNewModule(new PixelDigitizer("PixelDigitizer"));
+}
 
 EventAction::~EventAction(){}
 
 void EventAction::BeginOfEventAction(const G4Event*){}
 
 void EventAction::EndOfEventAction(const G4Event* event){
+	// Sampling weight of the primary vertex, whatever the hits
+	fRunAction->SetWeight(event->GetPrimaryVertex() ? event->GetPrimaryVertex()->GetWeight() : 1.);
+
 	// Hits collections
 	G4HCofThisEvent*HCE = event->GetHCofThisEvent();
 	if(!HCE) return;
@@ -58,6 +66,16 @@ void EventAction::EndOfEventAction(const G4Event* event){
 	}
 	
 	
+	if(fRunAction->GetCmdDigitize()){
+		G4DigiManager* DigiMan = G4DigiManager::GetDMpointer();
+		DigiMan->Digitize("PixelDigitizer");
+		PixelDigiCollection* DigiCollection = 
+			(PixelDigiCollection*) DigiMan->GetDigiCollection(DigiMan->GetDigiCollectionID("PixelDigitizer/pixelDigiCollection"));
+		if(DigiCollection){
+			for(size_t i = 0; i < DigiCollection->entries(); i++) fRunAction->FillWave((*DigiCollection)[i]->GetSignal());
+		}
+	}
+
 	ScintHit* scintHit;
 	G4int N = ScintHitCollection->entries();
 	PixelHit* pixelHit;
@@ -131,6 +149,7 @@ void EventAction::EndOfEventAction(const G4Event* event){
 			fRunAction->SetCellTime(pixelHit->GetCellTime());
 			fRunAction->SetOCTFlag(pixelHit->GetOCTFlag());
 			fRunAction->SetDNFlag(pixelHit->GetDNFlag());
+			fRunAction->SetAPFlag(pixelHit->GetAPFlag());
 			(fRunAction->GetTreePtr())->Fill();
 		}
 		scintHit->Clear();
@@ -7,6 +7,8 @@
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithAString.hh"
 
 PGActionMessenger::PGActionMessenger(PrimaryGeneratorAction* action) : G4UImessenger(), fPGAction(action){
 	fPrimary = new G4UIdirectory("/Primary/");
@@ -22,11 +24,54 @@ PGActionMessenger::PGActionMessenger(PrimaryGeneratorAction* action) : G4UImesse
 	fCmdDivergence->SetUnitCategory("angle");
 	fCmdDivergence->SetParameterName("divergence", false);
 	fCmdDivergence->AvailableForStates(G4State_Idle);
+
+	fCmdBatch = new G4UIcmdWithAnInteger("/Primary/Batch", this);
+	fCmdBatch->SetGuidance("Generate the vertices of this many events at once.");
+	fCmdBatch->SetGuidance("The vertices of a batch use the random numbers of its first event.");
+	fCmdBatch->SetGuidance("With more than 1 event the vertices are not reproducible event by event (in MT the batches depend on the thread scheduling).");
+	fCmdBatch->SetParameterName("events", false);
+	fCmdBatch->SetRange("events > 0");
+	fCmdBatch->AvailableForStates(G4State_Idle);
+
+	fCmdPhaseSpace = new G4UIcmdWithAString("/Primary/PhaseSpace", this);
+	fCmdPhaseSpace->SetGuidance("Read the primaries from a binary phase-space file, none for the gun.");
+	fCmdPhaseSpace->SetGuidance("Each worker thread reads its own slice of the file.");
+	fCmdPhaseSpace->SetParameterName("file", false);
+	fCmdPhaseSpace->AvailableForStates(G4State_Idle);
+
+	fCmdPhaseSpaceRecycle = new G4UIcmdWithABool("/Primary/PhaseSpaceRecycle", this);
+	fCmdPhaseSpaceRecycle->SetGuidance("Read the slice again, with random rotations around the beam axis, once it is over.");
+	fCmdPhaseSpaceRecycle->SetParameterName("recycle", false);
+	fCmdPhaseSpaceRecycle->AvailableForStates(G4State_Idle);
+
+	fCmdEnergySpectrum = new G4UIcmdWithAString("/Primary/EnergySpectrum", this);
+	fCmdEnergySpectrum->SetGuidance("Draw the kinetic energy from a tabulated spectrum: energy [MeV] density [sampling].");
+	fCmdEnergySpectrum->SetGuidance("michel for the positrons of muon decay, none for the gun energy.");
+	fCmdEnergySpectrum->SetParameterName("file", false);
+	fCmdEnergySpectrum->AvailableForStates(G4State_Idle);
+
+	fCmdAngularSpectrum = new G4UIcmdWithAString("/Primary/AngularSpectrum", this);
+	fCmdAngularSpectrum->SetGuidance("Draw theta from a tabulated spectrum: theta [deg] density [sampling], phi is uniform.");
+	fCmdAngularSpectrum->SetGuidance("none for the divergence mode.");
+	fCmdAngularSpectrum->SetParameterName("file", false);
+	fCmdAngularSpectrum->AvailableForStates(G4State_Idle);
+
+	fCmdAngularSpectrum2D = new G4UIcmdWithAString("/Primary/AngularSpectrum2D", this);
+	fCmdAngularSpectrum2D->SetGuidance("Draw the direction from a tabulated spectrum: theta [deg] phi [deg] density [sampling].");
+	fCmdAngularSpectrum2D->SetGuidance("none for the divergence mode.");
+	fCmdAngularSpectrum2D->SetParameterName("file", false);
+	fCmdAngularSpectrum2D->AvailableForStates(G4State_Idle);
 }
 
 PGActionMessenger::~PGActionMessenger(){
 	delete fCmdOCT;
 	delete fCmdDivergence;
+	delete fCmdBatch;
+	delete fCmdPhaseSpace;
+	delete fCmdPhaseSpaceRecycle;
+	delete fCmdEnergySpectrum;
+	delete fCmdAngularSpectrum;
+	delete fCmdAngularSpectrum2D;
 	delete fPrimary;
 }
 
@@ -37,4 +82,22 @@ void PGActionMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
 	else if(command == fCmdDivergence){
 		fPGAction->SetDivergence(fCmdDivergence->GetNewDoubleValue(newValue));
 	}
+	else if(command == fCmdBatch){
+		fPGAction->SetBatchSize(fCmdBatch->GetNewIntValue(newValue));
+	}
+	else if(command == fCmdPhaseSpace){
+		fPGAction->SetPhaseSpace(newValue == "none" ? "" : newValue);
+	}
+	else if(command == fCmdPhaseSpaceRecycle){
+		fPGAction->SetPhaseSpaceRecycle(fCmdPhaseSpaceRecycle->GetNewBoolValue(newValue));
+	}
+	else if(command == fCmdEnergySpectrum){
+		fPGAction->SetEnergySpectrum(newValue == "none" ? "" : newValue);
+	}
+	else if(command == fCmdAngularSpectrum){
+		fPGAction->SetAngularSpectrum(newValue == "none" ? "" : newValue, 1);
+	}
+	else if(command == fCmdAngularSpectrum2D){
+		fPGAction->SetAngularSpectrum(newValue == "none" ? "" : newValue, 2);
+	}
 }
@@ -0,0 +1,115 @@
+/// \file  ParameterSweep.cc
+/// \brief Implementation of the ParameterSweep class
+
+#include "ParameterSweep.hh"
+#include "SweepMessenger.hh"
+
+#include "G4UImanager.hh"
+#include "G4Exception.hh"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace {
+	// Parameter name, command and unit
+	const std::map<G4String, std::pair<G4String, G4String>> kParameters = {
+		{"CrysSize", {"/Element/det/CrysSize", "mm"}},
+		{"CrysMaterial", {"/Element/det/CrysMaterial", ""}},
+		{"SiPMmodel", {"/Element/det/SiPMmodel", ""}},
+		{"Angle", {"/Element/det/Angle", "deg"}},
+		{"AngleWOG", {"/Element/det/AngleWOG", "deg"}},
+		{"Tilt", {"/Element/det/Tilt", "mm"}},
+		{"Ground", {"/Element/det/Ground", ""}},
+		{"Energy", {"/gun/energy", "MeV"}},
+		{"Particle", {"/gun/particle", ""}}
+	};
+}
+
+ParameterSweep::ParameterSweep(){
+	fMessenger = new SweepMessenger(this);
+}
+
+ParameterSweep::~ParameterSweep(){
+	delete fMessenger;
+}
+
+void ParameterSweep::AddAxis(G4String name, std::vector<G4String> values){
+	if(fPoints.empty()) fPoints.push_back(std::vector<G4String>());
+	std::vector<std::vector<G4String>> points;
+	for(auto& point : fPoints){
+		for(auto& value : values){
+			points.push_back(point);
+			points.back().push_back(value);
+		}
+	}
+	fNames.push_back(name);
+	fPoints.swap(points);
+}
+
+G4bool ParameterSweep::LoadList(G4String fileName){
+	std::ifstream myfile(fileName);
+	if(!myfile.is_open()){
+		G4Exception("ParameterSweep::LoadList", "Sweep001", JustWarning, ("Cannot open " + fileName).c_str());
+		return false;
+	}
+	Clear();
+	std::string line;
+	while(std::getline(myfile, line)){
+		std::istringstream is(line);
+		std::vector<G4String> tokens;
+		std::string token;
+		while(is >> token) tokens.push_back(token);
+		if(tokens.empty() || tokens[0][0] == '#') continue;
+		if(fNames.empty()){
+			fNames = tokens;
+			continue;
+		}
+		if(tokens.size() != fNames.size()){
+			G4Exception("ParameterSweep::LoadList", "Sweep002", JustWarning, ("Skipping malformed line: " + line).c_str());
+			continue;
+		}
+		fPoints.push_back(tokens);
+	}
+	return true;
+}
+
+void ParameterSweep::Clear(){
+	fNames.clear();
+	fPoints.clear();
+}
+
+G4String ParameterSweep::Command(const G4String& name, const G4String& value){
+	auto it = kParameters.find(name);
+	if(it == kParameters.end()) return name + " " + value;
+	G4String command = it->second.first + " " + value;
+	if(it->second.second != "") command += " " + it->second.second;
+	return command;
+}
+
+void ParameterSweep::Run(G4int nEvents, G4String prefix){
+	G4UImanager* UImanager = G4UImanager::GetUIpointer();
+	for(size_t i = 0; i < fPoints.size(); i++){
+		const std::vector<G4String>& point = fPoints[i];
+		G4String tag = prefix;
+		G4bool valid = true;
+		UImanager->ApplyCommand("/Element/det/begin");
+		for(size_t j = 0; j < fNames.size(); j++){
+			G4String command = Command(fNames[j], point[j]);
+			if(UImanager->ApplyCommand(command) != 0){
+				G4Exception("ParameterSweep::Run", "Sweep003", JustWarning, ("Command failed, skipping the point: " + command).c_str());
+				valid = false;
+				break;
+			}
+			G4String name = fNames[j];
+			if(name[0] == '/') name = name.substr(name.find_last_of('/') + 1);
+			tag += "_" + name + "-" + point[j];
+		}
+		UImanager->ApplyCommand("/Element/det/commit");
+		if(!valid) continue;
+
+		G4cout << "Sweep point " << i + 1 << "/" << fPoints.size() << ": " << tag << G4endl;
+		UImanager->ApplyCommand("/Analysis/SetFileName " + tag + ".root");
+		UImanager->ApplyCommand("/run/beamOn " + std::to_string(nEvents));
+	}
+}
@@ -0,0 +1,112 @@
+/// \file  PhaseSpaceSource.cc
+/// \brief Implementation of the PhaseSpaceSource class
+
+#include "PhaseSpaceSource.hh"
+#include "BufferedRandom.hh"
+
+#include "G4ParticleGun.hh"
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4IonTable.hh"
+#include "G4Threading.hh"
+#include "G4Exception.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cmath>
+
+PhaseSpaceSource::PhaseSpaceSource(G4String fileName, G4bool recycle) :
+	fFileName(fileName), fRecycle(recycle), fMap(nullptr), fMapSize(0), fRecords(nullptr),
+	fNbOfRecords(0), fFirst(0), fLast(0), fIndex(0), fPass(0){
+	int fd = open(fileName.c_str(), O_RDONLY);
+	struct stat info;
+	if(fd < 0 || fstat(fd, &info) != 0){
+		if(fd >= 0) close(fd);
+		G4Exception("PhaseSpaceSource::PhaseSpaceSource", "PhaseSpace001", FatalException, ("Cannot open " + fileName).c_str());
+		return;
+	}
+	fNbOfRecords = info.st_size / sizeof(Record);
+	if(info.st_size % sizeof(Record) != 0){
+		G4Exception("PhaseSpaceSource::PhaseSpaceSource", "PhaseSpace002", JustWarning,
+			    (fileName + " is not a whole number of records, the last bytes are ignored").c_str());
+	}
+	if(fNbOfRecords > 0){
+		fMapSize = fNbOfRecords * sizeof(Record);
+		fMap = mmap(nullptr, fMapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(fMap == MAP_FAILED){
+			fMap = nullptr;
+			fNbOfRecords = 0;
+		}
+	}
+	close(fd);
+	if(!fMap){
+		G4Exception("PhaseSpaceSource::PhaseSpaceSource", "PhaseSpace001", FatalException, ("Cannot map " + fileName).c_str());
+		return;
+	}
+	fRecords = (const Record*) fMap;
+
+	// Slice of this thread (the whole file in sequential mode)
+	G4int thread = G4Threading::G4GetThreadId();
+	G4int nThreads = G4Threading::GetNumberOfRunningWorkerThreads();
+	if(thread < 0 || nThreads < 1){
+		thread = 0;
+		nThreads = 1;
+	}
+	fFirst = fNbOfRecords * thread / nThreads;
+	fLast = fNbOfRecords * (thread + 1) / nThreads;
+	fIndex = fFirst;
+	// the slice is read once from start to end
+	if(fLast > fFirst){
+		size_t page = sysconf(_SC_PAGESIZE);
+		size_t begin = fFirst * sizeof(Record) / page * page;
+		madvise((char*) fMap + begin, fLast * sizeof(Record) - begin, MADV_SEQUENTIAL);
+	}
+}
+
+PhaseSpaceSource::~PhaseSpaceSource(){
+	if(fMap) munmap(fMap, fMapSize);
+}
+
+G4bool PhaseSpaceSource::Next(G4ParticleGun* gun){
+	if(fIndex == fLast){
+		if(!fRecycle || fFirst == fLast) return false;
+		fIndex = fFirst;
+		fPass++;
+	}
+	const Record& record = fRecords[fIndex++];
+	G4ThreeVector position(record.x * mm, record.y * mm, record.z * mm);
+	G4ThreeVector momentum(record.px * MeV, record.py * MeV, record.pz * MeV);
+	if(fPass > 0){
+		G4double phi = BufferedRandom::GetInstance()->Flat() * twopi;
+		position.rotateZ(phi);
+		momentum.rotateZ(phi);
+	}
+
+	G4ParticleDefinition* particle = GetParticle(record.PDG);
+	G4double mass = particle->GetPDGMass();
+	gun->SetParticleDefinition(particle);
+	// from the kinetic energy: G4ParticleGun::SetParticleMomentum() prints a
+	// message at every call once an energy is set
+	gun->SetParticleEnergy(std::sqrt(momentum.mag2() + mass * mass) - mass);
+	gun->SetParticleMomentumDirection(momentum.unit());
+	gun->SetParticlePosition(position);
+	gun->SetParticleTime(record.t * ns);
+	return true;
+}
+
+G4ParticleDefinition* PhaseSpaceSource::GetParticle(G4int PDG){
+	auto it = fParticles.find(PDG);
+	if(it != fParticles.end()) return it->second;
+	G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(PDG);
+	if(!particle && PDG > 1000000000) particle = G4IonTable::GetIonTable()->GetIon(PDG);
+	if(!particle){
+		G4Exception("PhaseSpaceSource::GetParticle", "PhaseSpace003", FatalException,
+			    ("Unknown PDG code " + std::to_string(PDG) + " in " + fFileName).c_str());
+	}
+	fParticles[PDG] = particle;
+	return particle;
+}
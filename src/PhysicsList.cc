@@ -0,0 +1,75 @@
+/// \file  PhysicsList.cc
+/// \brief Implementation of the PhysicsList class
+
+#include "PhysicsList.hh"
+#include "PhysicsListMessenger.hh"
+#include "StartupCache.hh"
+
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4EmExtraPhysics.hh"
+#include "G4DecayPhysics.hh"
+#include "G4HadronElasticPhysics.hh"
+#include "G4HadronPhysicsFTFP_BERT.hh"
+#include "G4StoppingPhysics.hh"
+#include "G4IonPhysics.hh"
+#include "G4NeutronTrackingCut.hh"
+#include "G4OpticalPhysics.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4Exception.hh"
+#include "G4SystemOfUnits.hh"
+
+PhysicsList::PhysicsList(G4String configuration) : G4VModularPhysicsList(){
+	if(!IsConfiguration(configuration)){
+		G4Exception("PhysicsList::PhysicsList", "Phys001", FatalException, ("Unknown physics configuration " + configuration + " (FTFP_BERT or lean)").c_str());
+	}
+	G4cout << "PhysicsList: " << configuration << G4endl;
+	StartupCache::GetInstance()->SetPhysicsConfiguration(configuration);
+	SetDefaultCutValue(0.7*mm);
+
+	RegisterPhysics(new G4EmStandardPhysics_option4());
+	RegisterPhysics(new G4DecayPhysics());
+	if(configuration == "FTFP_BERT"){
+		RegisterPhysics(new G4EmExtraPhysics());
+		RegisterPhysics(new G4HadronElasticPhysics());
+		RegisterPhysics(new G4HadronPhysicsFTFP_BERT());
+		RegisterPhysics(new G4StoppingPhysics());
+		RegisterPhysics(new G4IonPhysics());
+		RegisterPhysics(new G4NeutronTrackingCut());
+	}
+
+	fOpticalPhysics = new G4OpticalPhysics();
+	//fOpticalPhysics->SetWLSTimeProfile("delta");
+	fOpticalPhysics->SetTrackSecondariesFirst(kCerenkov, true);
+	fOpticalPhysics->SetTrackSecondariesFirst(kScintillation, true);
+	RegisterPhysics(fOpticalPhysics);
+	// the step limits of the regions (DetectorConstruction)
+	RegisterPhysics(new G4StepLimiterPhysics());
+
+	fMessenger = new PhysicsListMessenger(this);
+}
+
+PhysicsList::~PhysicsList(){
+	delete fMessenger;
+}
+
+G4bool PhysicsList::IsConfiguration(G4String configuration){
+	return configuration == "FTFP_BERT" || configuration == "lean";
+}
+
+void PhysicsList::SetMaxNumPhotonsPerStep(G4int val){
+	fOpticalPhysics->SetMaxNumPhotonsPerStep(val);
+}
+
+void PhysicsList::SetMaxBetaChangePerStep(G4double val){
+	fOpticalPhysics->SetMaxBetaChangePerStep(val);
+}
+
+/// The materials must then have the <PARTICLE>SCINTILLATIONYIELD tables
+void PhysicsList::SetScintillationByParticleType(G4bool val){
+	fOpticalPhysics->SetScintillationByParticleType(val);
+}
+
+void PhysicsList::SetTrackSecondariesFirst(G4bool val){
+	fOpticalPhysics->SetTrackSecondariesFirst(kCerenkov, val);
+	fOpticalPhysics->SetTrackSecondariesFirst(kScintillation, val);
+}
@@ -0,0 +1,69 @@
+/// \file  PhysicsListMessenger.cc
+/// \brief Implementation of the PhysicsListMessenger class
+
+#include "PhysicsListMessenger.hh"
+#include "PhysicsList.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+
+PhysicsListMessenger::PhysicsListMessenger(PhysicsList* physicsList) : G4UImessenger(), fPhysicsList(physicsList){
+	fPhysDirectory = new G4UIdirectory("/Element/phys/");
+	fPhysDirectory->SetGuidance("Optical physics parameters, to be set before /run/initialize.");
+
+	fMaxPhotonsCmd = new G4UIcmdWithAnInteger("/Element/phys/MaxPhotonsPerStep", this);
+	fMaxPhotonsCmd->SetGuidance("Maximum number of Cerenkov photons per step (the step is shortened), -1 for no limit");
+	fMaxPhotonsCmd->SetParameterName("photons", false);
+	fMaxPhotonsCmd->AvailableForStates(G4State_PreInit);
+
+	fMaxBetaChangeCmd = new G4UIcmdWithADouble("/Element/phys/MaxBetaChange", this);
+	fMaxBetaChangeCmd->SetGuidance("Maximum change of beta (%) of the particle in a step with Cerenkov emission");
+	fMaxBetaChangeCmd->SetParameterName("change", false);
+	fMaxBetaChangeCmd->SetRange("change > 0");
+	fMaxBetaChangeCmd->AvailableForStates(G4State_PreInit);
+
+	fScintByParticleTypeCmd = new G4UIcmdWithABool("/Element/phys/ScintByParticleType", this);
+	fScintByParticleTypeCmd->SetGuidance("Scintillation yield depending on the particle type");
+	fScintByParticleTypeCmd->SetGuidance("The materials must have the <PARTICLE>SCINTILLATIONYIELD tables");
+	fScintByParticleTypeCmd->SetParameterName("byParticleType", false);
+	fScintByParticleTypeCmd->AvailableForStates(G4State_PreInit);
+
+	fTrackSecondariesFirstCmd = new G4UIcmdWithABool("/Element/phys/TrackSecondariesFirst", this);
+	fTrackSecondariesFirstCmd->SetGuidance("Track the Cerenkov and scintillation photons before the rest of the step (default true)");
+	fTrackSecondariesFirstCmd->SetParameterName("first", false);
+	fTrackSecondariesFirstCmd->AvailableForStates(G4State_PreInit);
+
+	// the physics list is shared, it is built by the master
+	fMaxPhotonsCmd->SetToBeBroadcasted(false);
+	fMaxBetaChangeCmd->SetToBeBroadcasted(false);
+	fScintByParticleTypeCmd->SetToBeBroadcasted(false);
+	fTrackSecondariesFirstCmd->SetToBeBroadcasted(false);
+}
+
+PhysicsListMessenger::~PhysicsListMessenger(){
+	delete fMaxPhotonsCmd;
+	delete fMaxBetaChangeCmd;
+	delete fScintByParticleTypeCmd;
+	delete fTrackSecondariesFirstCmd;
+	delete fPhysDirectory;
+}
+
+void PhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+	if(command == fMaxPhotonsCmd){
+		fPhysicsList->SetMaxNumPhotonsPerStep(fMaxPhotonsCmd->GetNewIntValue(newValue));
+	}
+
+	else if(command == fMaxBetaChangeCmd){
+		fPhysicsList->SetMaxBetaChangePerStep(fMaxBetaChangeCmd->GetNewDoubleValue(newValue));
+	}
+
+	else if(command == fScintByParticleTypeCmd){
+		fPhysicsList->SetScintillationByParticleType(fScintByParticleTypeCmd->GetNewBoolValue(newValue));
+	}
+
+	else if(command == fTrackSecondariesFirstCmd){
+		fPhysicsList->SetTrackSecondariesFirst(fTrackSecondariesFirstCmd->GetNewBoolValue(newValue));
+	}
+}
@@ -0,0 +1,20 @@
+/// \file  PixelDigi.cc
+/// \brief Implementation of the PixelDigi class
+
+#include "PixelDigi.hh"
+#include "G4ios.hh"
+
+G4ThreadLocal G4Allocator<PixelDigi>* PixelDigiAllocator = nullptr;
+
+PixelDigi::PixelDigi() : G4VDigi(){}
+
+PixelDigi::PixelDigi(const WaveSignal& signal) : G4VDigi(), fSignal(signal){}
+
+PixelDigi::~PixelDigi(){}
+
+void PixelDigi::Print(){
+	G4cout << "Channel " << fSignal.channel << " time " << fSignal.time << " ns amplitude " 
+	       << fSignal.amplitude << " charge " << fSignal.charge << G4endl;
+}
+
+
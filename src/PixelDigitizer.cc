@@ -0,0 +1,176 @@
+/// \file  PixelDigitizer.cc
+/// \brief Implementation of the PixelDigitizer class
+
+#include "PixelDigitizer.hh"
+#include "PixelHit.hh"
+#include "ScintHit.hh"
+#include "RunAction.hh"
+#include "BufferedRandom.hh"
+#include "SiPMModel.hh"
+
+#include "G4DigiManager.hh"
+#include "G4RunManager.hh"
+#include "G4Event.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+PixelDigitizer::PixelDigitizer(G4String name) : 
+	G4VDigitizerModule(name), fCollIDSiPM(-1), fCollIDScint(-1), fThreshold(0.1), fLatency(1*microsecond), 
+	fCFDFraction(0.2), fNoiseSeed(0){
+	collectionName.push_back("pixelDigiCollection");
+}
+
+PixelDigitizer::~PixelDigitizer(){}
+
+void PixelDigitizer::BeginOfRun(RunAction* action){
+	fThreshold = action->GetDigiThreshold();
+	fLatency = action->GetDigiLatency();
+
+	fChannelMap = ChannelMap();
+	if(action->GetDigiChannelMap() != "" && !fChannelMap.Load(action->GetDigiChannelMap())){
+		G4Exception("PixelDigitizer::BeginOfRun", "Digi001", JustWarning, 
+			    ("Cannot read the channel map " + action->GetDigiChannelMap() + ", one channel per element").c_str());
+	}
+
+	// Gain smearing density as in digitize
+	fSmearing.reset();
+	if(action->GetDigiSmearing() != ""){
+		std::ifstream myfile(action->GetDigiSmearing());
+		G4double pars[3];
+		if(myfile >> pars[0] >> pars[1] >> pars[2]){
+			fSmearing.reset(new TabulatedSampler([pars](G4double x){
+				if(x < pars[0]) return std::exp(-(x - pars[0]) * (x - pars[0]) / 2 / (pars[1] * pars[1] + 2 * x * pars[2]));
+				return std::exp(-0.5 * (x - pars[0]) * (x - pars[0]) / pars[1] / pars[1]);
+			}, 0, 2));
+		}
+		else{
+			G4Exception("PixelDigitizer::BeginOfRun", "Digi002", JustWarning, 
+				    ("Cannot read " + action->GetDigiSmearing() + ", no gain smearing").c_str());
+		}
+	}
+
+	if(!fPulse) fPulse.reset(new PulseTemplate());
+
+	fCFDFraction = action->GetDigiCFDFraction();
+	fNoise.reset();
+	if(action->GetDigiNoise() > 0){
+		fNoise.reset(new NoiseGenerator(fPulse->GetPitch(), action->GetDigiNoise(), action->GetDigiNoiseBandwidth()));
+		if(action->GetDigiNoiseSpectrum() != "" && !fNoise->Load(action->GetDigiNoiseSpectrum())){
+			G4Exception("PixelDigitizer::BeginOfRun", "Digi005", JustWarning, 
+				    ("Cannot read the noise spectrum " + action->GetDigiNoiseSpectrum() + ", one-pole spectrum").c_str());
+		}
+		// the noise of each channel from the random engine of the thread
+		fNoiseSeed = (unsigned long) (BufferedRandom::GetInstance()->Flat() * 4294967296.);
+	}
+	fChannels.clear();
+	fPending = decltype(fPending)();
+	fSplitter.reset(new ChannelSplitter(&fChannelMap, [this](int channel, const CellHit& hit){
+		GetChannel(channel)->AddHit(hit, fSmearing ? fSmearing->Sample(BufferedRandom::GetInstance()->Flat()) : 1.);
+	}, Model::dead_time / ns));
+}
+
+WaveformDigitizer* PixelDigitizer::GetChannel(G4int channel){
+	if(channel >= G4int(fChannels.size())) fChannels.resize(channel + 1);
+	if(!fChannels[channel]){
+		fChannels[channel].reset(new WaveformDigitizer(fPulse.get(), fThreshold));
+		fChannels[channel]->SetChannel(channel);
+		fChannels[channel]->SetCFDFraction(fCFDFraction);
+		if(fNoise){
+			std::seed_seq sequence{fNoiseSeed, (unsigned long) channel};
+			std::mt19937_64 engine(sequence);
+			fChannels[channel]->SetNoise(fNoise.get());
+			fChannels[channel]->SetNoiseSeed(engine());
+		}
+	}
+	return fChannels[channel].get();
+}
+
+void PixelDigitizer::Digitize(){
+	G4DigiManager* DigiMan = G4DigiManager::GetDMpointer();
+	if(fCollIDSiPM < 0) fCollIDSiPM = DigiMan->GetHitsCollectionID("pixelCollection");
+	if(fCollIDScint < 0) fCollIDScint = DigiMan->GetHitsCollectionID("scintCollection");
+	PixelHitsCollection* PixelHitCollection = (PixelHitsCollection*) DigiMan->GetHitsCollection(fCollIDSiPM);
+	ScintHitsCollection* ScintHitCollection = (ScintHitsCollection*) DigiMan->GetHitsCollection(fCollIDScint);
+
+	RunAction* action = (RunAction*) G4RunManager::GetRunManager()->GetUserRunAction();
+	G4double gunTime = action->GetGunTime();
+	const G4Event* event = G4RunManager::GetRunManager()->GetCurrentEvent();
+
+	if(PixelHitCollection && PixelHitCollection->entries() > 0){
+		PixelHit* pixelHit = (*PixelHitCollection)[0];
+		CellHit hit;
+		hit.eventID = event ? event->GetEventID() : 0;
+		if(ScintHitCollection && ScintHitCollection->entries() > 0){
+			ScintHit* scintHit = (*ScintHitCollection)[0];
+			hit.trackLength = scintHit->GetTrackLength();
+			hit.thetaIn = scintHit->GetThetaIn();
+			hit.bounce = scintHit->GetBounce();
+		}
+		std::vector<G4int> cells = pixelHit->GetCells();
+		std::vector<G4double> times = pixelHit->GetCellTime();
+		std::vector<G4int> DN = pixelHit->GetDNFlag();
+		for(size_t i = 0; i < cells.size(); i++){
+			hit.cell = cells[i];
+			hit.time = times[i] / ns;
+			hit.timeEv = (times[i] - gunTime) / ns;
+			hit.DN = DN.at(i);
+			fPending.push(hit);
+		}
+	}
+
+	// The cells of the next events cannot be earlier than this: their gun
+	// time is later and their dark noise starts at the next DN time, which
+	// lags behind as long as no photon reaches the SiPM
+	G4double horizon = gunTime;
+	if(action->GetCmdDN()) horizon = std::min(horizon, action->GetDNTime());
+	Release((horizon - fLatency) / ns);
+
+	std::vector<WaveSignal> signals;
+	Collect(signals);
+	PixelDigiCollection* DigiCollection = new PixelDigiCollection(moduleName, collectionName[0]);
+	for(auto& signal : signals) DigiCollection->insert(new PixelDigi(signal));
+	StoreDigiCollection(DigiCollection);
+}
+
+/// Feed the cells before time (ns) to the channels and advance them
+void PixelDigitizer::Release(G4double time){
+	while(!fPending.empty() && fPending.top().time < time){
+		fSplitter->Add(fPending.top());
+		fPending.pop();
+	}
+	for(auto& channel : fChannels) if(channel) channel->AdvanceTo(time);
+}
+
+void PixelDigitizer::Collect(std::vector<WaveSignal>& signals){
+	for(auto& channel : fChannels){
+		if(!channel) continue;
+		signals.insert(signals.end(), channel->GetSignals().begin(), channel->GetSignals().end());
+		channel->GetSignals().clear();
+	}
+}
+
+std::vector<WaveSignal> PixelDigitizer::EndOfRun(){
+	while(!fPending.empty()){
+		fSplitter->Add(fPending.top());
+		fPending.pop();
+	}
+	long late = 0;
+	for(auto& channel : fChannels){
+		if(!channel) continue;
+		channel->Flush();
+		late += channel->GetNbOfLateHits();
+	}
+	if(late > 0){
+		G4Exception("PixelDigitizer::EndOfRun", "Digi003", JustWarning, 
+			    (std::to_string(late) + " cells arrived after their samples were finalized and were delayed, increase /Element/det/DigiLatency").c_str());
+	}
+	std::vector<WaveSignal> signals;
+	Collect(signals);
+	return signals;
+}
+
+
@@ -8,6 +8,7 @@
 #include "G4Transform3D.hh"
 #include "G4RotationMatrix.hh"
 #include "G4ThreeVector.hh"
+#include "G4Box.hh"
 
 G4ThreadLocal G4Allocator<PixelHit>* PixelHitAllocator = nullptr;
 
@@ -24,8 +25,11 @@ PixelHit::PixelHit(const PixelHit &right) : G4VHit(){
 	fCellTime = right.fCellTime; // vector of arrive time in cell
 	fOCTflag = right.fOCTflag;
 	fDNflag = right.fDNflag;
+	fAPflag = right.fAPflag;
 	fPhysVolMother = right.fPhysVolMother;
 	fPhysVolGMother = right.fPhysVolGMother;
+	fPixelOffset = right.fPixelOffset;
+	fPixelHalfSize = right.fPixelHalfSize;
 	fDrawit = right.fDrawit;
 	fPixelNumber = right.fPixelNumber;
 }
@@ -37,9 +41,12 @@ const PixelHit& PixelHit::operator=(const PixelHit &right){
 	fCellTime = right.fCellTime; // vector of arrive time in cell
 	fOCTflag = right.fOCTflag;
 	fDNflag = right.fDNflag;
+	fAPflag = right.fAPflag;
 	fPhysVol = right.fPhysVol;
 	fPhysVolMother = right.fPhysVolMother;
 	fPhysVolGMother = right.fPhysVolGMother;
+	fPixelOffset = right.fPixelOffset;
+	fPixelHalfSize = right.fPixelHalfSize;
 	fDrawit = right.fDrawit;
 	fPixelNumber = right.fPixelNumber;
 	return* this;
@@ -62,8 +69,15 @@ void PixelHit::Draw(){
 			G4ThreeVector pos = fPhysVol->GetTranslation();
 			if(fPhysVolMother != nullptr) pos += fPhysVolMother->GetTranslation();
 			if(fPhysVolGMother != nullptr) pos += fPhysVolGMother->GetTranslation();
-			G4Transform3D trans(rot, pos);
-			pVVisManager->Draw(*fPhysVol, attribs, trans);
+			if(fPixelHalfSize.x() > 0){
+				G4Box pixel("PixelHit", fPixelHalfSize.x(), fPixelHalfSize.y(), fPixelHalfSize.z());
+				G4Transform3D trans(rot, pos + fPixelOffset);
+				pVVisManager->Draw(pixel, attribs, trans);
+			}
+			else{
+				G4Transform3D trans(rot, pos);
+				pVVisManager->Draw(*fPhysVol, attribs, trans);
+			}
 
 		}
 	}
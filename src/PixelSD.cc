@@ -4,6 +4,7 @@
 #include "PixelSD.hh"
 #include "PixelHit.hh"
 #include "RunAction.hh"
+#include "SiPMCatalogue.hh"
 
 #include "G4Track.hh"
 #include "G4Step.hh"
@@ -18,14 +19,16 @@
 #include "G4Box.hh"
 
 #include "Randomize.hh"
+#include "BufferedRandom.hh"
+#include "G4Poisson.hh"
 
 
 class DetectorConstruction;
 
 
 PixelSD::PixelSD(G4String name, G4String model) : 
-	G4VSensitiveDetector(name), fNCells(0), fNPhotoElectrons(0), fVoltage(56), 
-	fDetEffGain(0), fPhotonGain(0), fOCT(0){
+	G4VSensitiveDetector(name), fNCells(0), fNDetected(0), fNPhotoElectrons(0), fVoltage(56), 
+	fDetEffGain(0), fPhotonGain(0), fOCT(0), fAfterpulseProb(0), fAfterpulseTau(0){
 	fPixelCollection = nullptr;
 	collectionName.insert("pixelCollection");
 	fPixelCollectionDraw = nullptr;
@@ -36,225 +39,56 @@ PixelSD::PixelSD(G4String name, G4String model) :
 	filename[2] = "";
 	filename[3] = "";
 	fNbOfPixels = 0;
+	fNbOfPixelsX = 0;
+	fNbOfPixelsY = 0;
+	fVirtualPixels = false;
+	fDevice = nullptr;
 	fModel = model;
 }
 
 PixelSD::~PixelSD(){}
 
 G4double PixelSD::GetAbsProbability(G4double val){
-	G4double temp = 0;
-	G4int N =fDetEffx.size();
-	for(int i = 0; i < N; i++){
-		if(i == 0){
-			if((fDetEffx.at(1) - fDetEffx.at(0)) / 2 > val - fDetEffx.at(0)){
-				if(val > fDetEffx.at(0)) temp = fDetEff.at(0);
-				break;
-			}
-		}
-
-		else if(i == N - 1){
-			if((fDetEffx.at(N - 1) - fDetEffx.at(N - 2)) / 2 > fDetEffx.at(N - 1) - val){
-				if(val < fDetEffx.at(N - 1)) temp = fDetEff.at(N - 1);
-				break;
-			}
-		}
-
-		else{
-			if((fDetEffx.at(i) - fDetEffx.at(i - 1)) / 2 > fDetEffx.at(i) - val && 
-			   (fDetEffx.at(i + 1) - fDetEffx.at(i)) / 2 > val - fDetEffx.at(i)){
-				temp = fDetEff.at(i);
-				break;
-			}
-		}
-	}
-	return temp * fDetEffGain;
+	return fDevice->GetDetEff(val) * fDetEffGain;
 }
 
 void PixelSD::SetDetEffGain(){
-	std::vector<G4double> DetEffGain;
-	std::vector<G4double> DetEffGainx;
-	G4double x, y;
-
-	std::ifstream myfile;
-	myfile.open("../tables/" + this->GetFileName(1));
-	while(true){
-		myfile >> x >> y;
-		DetEffGainx.push_back(x); // x is a voltage (over the breakdown threashold)
-		DetEffGain.push_back(y);
-		if(myfile.eof()) break;
-	}
-	myfile.close();
-
-	G4double temp = 0;
-	G4int N =DetEffGainx.size();
-	G4double val = fVoltage - 53;
-	for(int i = 0; i < N; i++){
-		if(i == 0){
-			if((DetEffGainx.at(1) - DetEffGainx.at(0)) / 2 > val - DetEffGainx.at(0)){
-				temp = DetEffGain.at(0);
-				break;
-			}
-		}
-
-		else if(i == N - 1){
-			if((DetEffGainx.at(N - 1) - DetEffGainx.at(N - 2)) / 2 > DetEffGainx.at(N - 1) - val){
-				temp = DetEffGain.at(N - 1);
-				break;
-			}
-		}
-		else{
-			if((DetEffGainx.at(i) - DetEffGainx.at(i - 1)) / 2 > DetEffGainx.at(i) - val && 
-			   (DetEffGainx.at(i + 1) - DetEffGainx.at(i)) / 2 > val - DetEffGainx.at(i)){
-				temp = DetEffGain.at(i);
-				break;
-			}
-		}
-	}
-
-	fDetEffGain = temp / 0.5;
-	DetEffGain.clear();
-	DetEffGainx.clear();	
+	fDetEffGain = fDevice->GetDetEffGain(fVoltage - 53) / 0.5;
 }
 
 
 void PixelSD::SetPhotonGain(){
-	std::vector<G4double> PhotonGain;
-	std::vector<G4double> PhotonGainx;
-	G4double x, y;
-	std::ifstream myfile;
-	myfile.open("../tables/" + this->GetFileName(3));
-	while(true){
-		myfile >> x >> y;
-		PhotonGainx.push_back(x); // x is a voltage (over the breakdown threashold)
-		PhotonGain.push_back(y);
-		if(myfile.eof()) break;
-	}
-	myfile.close();
-
-	G4double temp = 0;
-	G4int N =PhotonGainx.size();
-	G4double val = fVoltage - 53;
-	for(int i = 0; i < N; i++){
-		if(i == 0){
-			if((PhotonGainx.at(1) - PhotonGainx.at(0)) / 2 > val - PhotonGainx.at(0)){
-				temp = PhotonGain.at(0);
-				break;
-			}
-		}
-
-		else if(i == N - 1){
-			if((PhotonGainx.at(N - 1) - PhotonGainx.at(N - 2)) / 2 > PhotonGainx.at(N - 1) - val){
-				temp = PhotonGain.at(N - 1);
-				break;
-			}
-		}
-
-		else{
-			if( (PhotonGainx.at(i) - PhotonGainx.at(i - 1)) / 2 > PhotonGainx.at(i) -val  &&
-				(PhotonGainx.at(i + 1) - PhotonGainx.at(i)) / 2 > val - PhotonGainx.at(i)){
-				temp = PhotonGain.at(i);
-				break;
-			}
-		}
-	}
-
-	fPhotonGain = temp;
-	PhotonGain.clear();
-	PhotonGainx.clear();
+	fPhotonGain = fDevice->GetPhotonGain(fVoltage - 53);
 }
 
 void PixelSD::SetOCT(){
-	std::vector<G4double> OCT;
-	std::vector<G4double> OCTx;
-	G4double x, y;
-	std::ifstream myfile;
-	myfile.open("../tables/" + this->GetFileName(2));
-	while(true){
-		myfile >> x >> y;
-		OCTx.push_back(x); // x is a voltage (over the breakdown threashold)
-		OCT.push_back(y);
-		if(myfile.eof()) break;
-	}
-	myfile.close();
-
-	G4double temp = 0;
-	G4int N =OCTx.size();
-	G4double val = fVoltage - 53;
-	for(int i = 0; i < N; i++){
-		if(i == 0){
-			if((OCTx.at(1) - OCTx.at(0)) / 2 > val - OCTx.at(0)){
-				temp = OCT.at(0);
-				break;
-			}
-		}
-
-		else if(i == N - 1){
-			if((OCTx.at(N - 1) - OCTx.at(N - 2)) / 2 > OCTx.at(N - 1) - val){
-				temp = OCT.at(N - 1);
-				break;
-			}
-		}
-
-		else{
-			if( (OCTx.at(i) - OCTx.at(i - 1)) / 2 > OCTx.at(i) -val  &&  
-				(OCTx.at(i + 1) - OCTx.at(i)) / 2 > val - OCTx.at(i)){
-				temp = OCT.at(i);
-				break;
-			}
-		}
-	}
-
-	fOCT = temp;
-	OCT.clear();
-	OCTx.clear();
+	fOCT = fDevice->GetOCTGain(fVoltage - 53);
 }
 
 void PixelSD::DefineProperties(){
-	G4int i = 0, j = 0; //i is for the pitch, j is for the window material;
-	if (fModel == "75PE") {i = 0; j = 1;}
-	else if (fModel == "50PE") {i = 1; j = 1;}
-	else if (fModel == "25PE") {i = 2; j = 1;}
-	else if (fModel == "75CS") {i = 0; j = 0;}
-	else if (fModel == "50CS") {i = 1; j = 0;}
-	else if (fModel == "25CS") {i = 2; j = 0;};
-
-	SetNbOfPixels(Model::NbPixelsX[i] * Model::NbPixelsY[i]);
-
-	filename[0] = Model::eff_name[i + j * 3];
-	filename[1] = Model::eff_gain_name[i];
-	filename[2] = Model::OCT_gain_name[i];
-	filename[3] = Model::photon_gain_name[i];
-		
-	std::ifstream myfile;
-	myfile.open("../tables/" + this->GetFileName(0));
-	G4double x, y;
-	while(true){
-		myfile >> x >> y;
-		fDetEffx.push_back(1239.84197/x); // x is the light wave length
-		fDetEff.push_back(y);
-		if(myfile.eof()) break;
+	fDevice = SiPMCatalogue::GetInstance()->GetDevice(fModel);
+	if(!fDevice){
+		G4Exception("PixelSD::DefineProperties", "SiPM003", FatalException, ("Unknown SiPM model " + fModel).c_str());
 	}
-	myfile.close();
-	std::reverse(fDetEffx.begin(), fDetEffx.end());
-	std::reverse(fDetEff.begin(), fDetEff.end());
 
-	fFillFactor = Model::FillFactor[i];
+	fNbOfPixelsX = fDevice->nbPixelsX;
+	fNbOfPixelsY = fDevice->nbPixelsY;
+	SetNbOfPixels(fNbOfPixelsX * fNbOfPixelsY);
+
+	for(G4int i = 0; i < 4; i++) filename[i] = fDevice->tables[i];
+
+	fFillFactor = fDevice->fillFactor;
 	
-	SetVoltage(53 + Model::OVoltage[i]);
+	SetVoltage(53 + fDevice->overVoltage);
 	SetDetEffGain();
 	SetPhotonGain();
 	SetOCT();
 	std::cout << "OCT = " << fOCT << std::endl;
-	fOCT = fOCT * Model::OCT_factor[i];
+	fOCT = fOCT * fDevice->OCTFactor;
 	std::cout << "OCT times factor = " << fOCT << std::endl;
-	firstStep.clear();
-	activationTime.clear();
-	isParent.clear();
-	for(i = 0; i < this->GetNbOfPixels(); i++){
-		firstStep.push_back(0);
-		activationTime.push_back(0);
-		isParent.push_back(-1);
-	}
+	fCellState.Resize(this->GetNbOfPixels());
+	fAfterpulseProb = fDevice->afterpulseProb;
+	fAfterpulseTau  = fDevice->afterpulseTau;
 }
 
 void PixelSD::Initialize(G4HCofThisEvent* hitsCE){
@@ -272,8 +106,63 @@ void PixelSD::Initialize(G4HCofThisEvent* hitsCE){
 
 	fCmdOCT = ((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->GetCmdOCT();
 	fCmdDN  = ((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->GetCmdDN();
+	fCmdAP  = ((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->GetCmdAP();
+	fCmdSaturation = ((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->GetCmdSaturation();
+	// without recovery a cell fires again at full charge after the hold-off
+	G4bool recovery = ((RunAction*) G4RunManager::GetRunManager()->GetUserRunAction())->GetCmdRecovery();
+	fCellState.SetRecovery(Model::dead_time, recovery ? fDevice->recoveryTime : 0);
+	fRandom = BufferedRandom::GetInstance();
 }
 
+/// Saturation-only response: the detected photons of the event are turned
+/// into fired cells with the analytic occupancy N (1 - exp(-n/N)), smeared
+/// binomially, and crosstalk adds a Poisson number of avalanches that
+/// saturate in the same way in the remaining free cells
+void PixelSD::SaturationResponse(){
+	G4int N = this->GetNbOfPixels();
+	if(fNDetected <= 0 || N <= 0) return;
+	G4double occupancy = 1 - std::exp(- G4double(fNDetected) / N);
+	G4int fired = G4int(CLHEP::RandBinomial::shoot(N, occupancy));
+	if(fCmdOCT && fired > 0 && fired < N){
+		G4int nFree = N - fired;
+		G4double crosstalk = G4Poisson(fired * fOCT);
+		fired += G4int(CLHEP::RandBinomial::shoot(nFree, 1 - std::exp(- crosstalk / nFree)));
+	}
+	fNCells = fired;
+	fNPhotoElectrons = fired * fPhotonGain;
+}
+
+/// Trapped carriers released after the avalanche fire the same cell again,
+/// with a charge reduced by the cell recovery. The carriers are held during
+/// the hold-off: the release delay (APtau) is counted from its end, so the
+/// afterpulse only misses when the cell has not recovered (recovery 0). The
+/// cell is fired at the afterpulse time and counted in NCells as the
+/// avalanches: if it is not later than the hold-off before ptime, the time
+/// of the photon being processed.
+void PixelSD::Afterpulse(G4int cell, G4double time, G4double ptime){
+	if(!fCmdAP || fRandom->Flat() >= fAfterpulseProb) return;
+	G4double apTime = time + fCellState.GetDeadTime() + fRandom->Exponential(fAfterpulseTau);
+	G4double recovery = fCellState.GetRecovery(cell, apTime);
+	if(recovery <= 0) return;
+	fCellState.Fire(cell, apTime);
+	if(ptime - apTime < Model::dead_time) fNCells += 1;
+	fNPhotoElectrons += fPhotonGain * recovery;
+	fCells.push_back(cell);
+	fCellTime.push_back(apTime);
+	fOCTflagvec.push_back(0);
+	fDNflagvec.push_back(0);
+	fAPflagvec.push_back(1);
+}
+
+/// Pixel index from the position in the single active volume, numbered as
+/// the placements of DetectorConstruction (x runs fastest)
+G4int PixelSD::GetVirtualPixel(const G4ThreeVector& localPos, const G4Box* box){
+	G4int i = G4int((localPos.x() + box->GetXHalfLength()) / (2 * box->GetXHalfLength()) * fNbOfPixelsX);
+	G4int j = G4int((localPos.y() + box->GetYHalfLength()) / (2 * box->GetYHalfLength()) * fNbOfPixelsY);
+	i = std::min(std::max(i, 0), fNbOfPixelsX - 1);
+	j = std::min(std::max(j, 0), fNbOfPixelsY - 1);
+	return i + j * fNbOfPixelsX;
+}
 
 G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 	if(aStep->GetTrack()->GetParticleDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()){
@@ -284,18 +173,23 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
     		G4ThreeVector localpos1 = 
       			theTouchable->GetHistory()->GetTopTransform().TransformPoint(stppos1);
 		G4VPhysicalVolume* physVol = aStep->GetPreStepPoint()->GetTouchable()->GetVolume(0);
-		G4double dimensions = - ((G4Box*) physVol->GetLogicalVolume()->GetSolid())->GetZHalfLength();
+		G4Box* pixelBox = (G4Box*) physVol->GetLogicalVolume()->GetSolid();
+		G4double dimensions = - pixelBox->GetZHalfLength();
 
 		if(aStep->GetPreStepPoint()->GetStepStatus() == fGeomBoundary && 
 		   std::fabs(localpos1.z() + dimensions) < kCarTolerance){
 
 //		if(aStep->GetPreStepPoint()->GetStepStatus() == fGeomBoundary){
 			G4double energy = aStep->GetPreStepPoint()->GetKineticEnergy();
-			G4double a = G4UniformRand();
+			G4double a = fRandom->Flat();
 			G4double p = GetAbsProbability(energy/CLHEP::eV);
 			fOCTflag = 0;
-			if(a < p){ // SiPM Fill Factor
-				G4int replica = aStep->GetPreStepPoint()->GetTouchable()->GetReplicaNumber(0);
+			if(a < p && fCmdSaturation){
+				fNDetected += 1;
+			}
+			else if(a < p){ // SiPM Fill Factor
+				G4int replica = fVirtualPixels ? GetVirtualPixel(localpos1, pixelBox) : 
+					aStep->GetPreStepPoint()->GetTouchable()->GetReplicaNumber(0);
 //				G4VPhysicalVolume* physVol = aStep->GetPreStepPoint()->GetTouchable()->GetVolume(0);
 				G4VPhysicalVolume* physVolM = aStep->GetPreStepPoint()->GetTouchable()->GetVolume(1);
 				G4VPhysicalVolume* physVolGM = aStep->GetPreStepPoint()->GetTouchable()->GetVolume(2);
@@ -314,6 +208,13 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 					hit->SetPixelPhysVolMother(physVolM);
 					hit->SetPixelPhysVolGMother(physVolGM);
 					hit->SetDrawit(true);
+					if(fVirtualPixels){
+						G4double sizeX = 2 * pixelBox->GetXHalfLength() / fNbOfPixelsX;
+						G4double sizeY = 2 * pixelBox->GetYHalfLength() / fNbOfPixelsY;
+						hit->SetPixelOffset(G4ThreeVector(sizeX * (replica % fNbOfPixelsX + 0.5) - pixelBox->GetXHalfLength(), 
+										  sizeY * (replica / fNbOfPixelsX + 0.5) - pixelBox->GetYHalfLength(), 0));
+						hit->SetPixelHalfSize(G4ThreeVector(0.5 * sizeX, 0.5 * sizeY, pixelBox->GetZHalfLength()));
+					}
 					fPixelCollectionDraw->insert(hit);
 				}
 
@@ -321,18 +222,18 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 				G4double ptime = aStep->GetPreStepPoint()->GetGlobalTime() + action->GetGunTime();
 				if(fCmdDN){
 					while(action->GetDNTime() < ptime){
-						G4int DNcell = int(G4UniformRand() * this->GetNbOfPixels());
-						if(firstStep[DNcell] == 0 || action->GetDNTime() - activationTime.at(DNcell) > 20*CLHEP::nanosecond){
-							firstStep.at(DNcell) = 1;
-							activationTime.at(DNcell) = action->GetDNTime();
-							if(ptime - action->GetDNTime() < 20*CLHEP::nanosecond) fNCells += 1;
-							fNPhotoElectrons += fPhotonGain;
+						G4int DNcell = int(fRandom->Flat() * this->GetNbOfPixels());
+						G4double recovery = fCellState.GetRecovery(DNcell, action->GetDNTime());
+						if(recovery >= 1 || (recovery > 0 && fRandom->Flat() < recovery)){
+							fCellState.Fire(DNcell, action->GetDNTime());
+							if(ptime - action->GetDNTime() < Model::dead_time) fNCells += 1;
+							fNPhotoElectrons += fPhotonGain * recovery;
 							fCells.push_back(DNcell);
 							fCellTime.push_back(action->GetDNTime());
-							if(fCmdOCT && G4UniformRand() < fOCT){
-								G4double cost = G4UniformRand() * 2 - 1;
+							if(fCmdOCT && fRandom->Flat() < fOCT){
+								G4double cost = fRandom->Flat() * 2 - 1;
 								G4double sint = sqrt(1 - cost * cost);
-								G4double phi  = G4UniformRand() * 2 * CLHEP::pi;
+								G4double phi  = fRandom->Flat() * 2 * CLHEP::pi;
 								G4ThreeVector dir = G4ThreeVector(sint * cos(phi), sint * sin(phi), cost);
 								G4DynamicParticle* dynOCT = new G4DynamicParticle(G4OpticalPhoton::OpticalPhotonDefinition(), dir, 2*CLHEP::eV);
 								G4Track* OCT = new G4Track(dynOCT, aStep->GetPreStepPoint()->GetGlobalTime(), aStep->GetPreStepPoint()->GetPosition());
@@ -343,18 +244,23 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 							}
 							else fOCTflagvec.push_back(0);
 							fDNflagvec.push_back(1);
+							fAPflagvec.push_back(0);
+							Afterpulse(DNcell, action->GetDNTime(), ptime);
 						}
 						action->AdvanceDNTime();
 					}
 				}
-				if(firstStep[replica] == 0 || (ptime - activationTime[replica] > 20*CLHEP::nanosecond && fCmdDN)){
+				G4double recovery = fCellState.IsFired(replica) ? (fCmdDN ? fCellState.GetRecovery(replica, ptime) : 0) : 1;
+				G4bool fired = false;
+				if(recovery >= 1 || (recovery > 0 && fRandom->Flat() < recovery)){
+					fired = true;
 					fNCells += 1;
-					fNPhotoElectrons += fPhotonGain;
-					activationTime.at(replica) = ptime;
-					if(fCmdOCT && G4UniformRand() < fOCT){
-						G4double cost = G4UniformRand() * 2 - 1;
+					fNPhotoElectrons += fPhotonGain * recovery;
+					fCellState.SetTime(replica, ptime);
+					if(fCmdOCT && fRandom->Flat() < fOCT){
+						G4double cost = fRandom->Flat() * 2 - 1;
 						G4double sint = sqrt(1 - cost * cost);
-						G4double phi  = G4UniformRand() * 2 * CLHEP::pi;
+						G4double phi  = fRandom->Flat() * 2 * CLHEP::pi;
 						G4ThreeVector dir = G4ThreeVector(sint * cos(phi), sint * sin(phi), cost);
 						G4DynamicParticle* dynOCT = new G4DynamicParticle(G4OpticalPhoton::OpticalPhotonDefinition(), dir, 2*CLHEP::eV);
 						G4Track* OCT = new G4Track(dynOCT, aStep->GetPreStepPoint()->GetGlobalTime(), aStep->GetPreStepPoint()->GetPosition());
@@ -363,27 +269,30 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 						newTrack->push_back(OCT);
 					}
 					if(aStep->GetTrack()->GetParentID() < 0){
-						isParent.at(- (aStep->GetTrack()->GetParentID() + 1)) = replica;
+						fCellState.SetChild(- (aStep->GetTrack()->GetParentID() + 1), replica);
 						fOCTflag = 1;
 					}
 				}
 
-				else if(ptime < activationTime[replica] && aStep->GetTrack()->GetParentID() < 10){
-					if(isParent.at(replica) != -1){
-						G4double tempTime = activationTime.at(replica);
+				else if(ptime < fCellState.GetTime(replica) && aStep->GetTrack()->GetParentID() < 10){
+					if(fCellState.GetChild(replica) != -1){
+						G4double tempTime = fCellState.GetTime(replica);
 						G4int tempID = replica;
-						while(isParent.at(tempID) != -1){
-							activationTime.at(isParent.at(tempID)) -= (tempTime - ptime);
-							tempID = isParent.at(tempID);
+						while(fCellState.GetChild(tempID) != -1){
+							G4int child = fCellState.GetChild(tempID);
+							fCellState.SetTime(child, fCellState.GetTime(child) - (tempTime - ptime));
+							tempID = child;
 						}
 					}
-					activationTime.at(replica) = ptime;
+					fCellState.SetTime(replica, ptime);
 				}
-				firstStep.at(replica) = 1;
+				fCellState.Fire(replica, fCellState.GetTime(replica));
 				fCells.push_back(replica);
 				fCellTime.push_back(ptime);
 				fOCTflagvec.push_back(fOCTflag);
 				fDNflagvec.push_back(0);
+				fAPflagvec.push_back(0);
+				if(fired) Afterpulse(replica, ptime, ptime);
 			}
 
 			aStep->GetTrack()->SetTrackStatus(fStopAndKill);
@@ -394,6 +303,7 @@ G4bool PixelSD::ProcessHits(G4Step *aStep, G4TouchableHistory*){
 }
 
 void PixelSD::EndOfEvent(G4HCofThisEvent*){
+	if(fCmdSaturation) SaturationResponse();
 	PixelHit* Hit = new PixelHit();
 	Hit->SetNCells(fNCells);
 	Hit->SetNPhotoElectrons(fNPhotoElectrons);
@@ -401,16 +311,19 @@ void PixelSD::EndOfEvent(G4HCofThisEvent*){
 	Hit->SetCellTime(fCellTime);
 	Hit->SetOCTFlag(fOCTflagvec);
 	Hit->SetDNFlag(fDNflagvec);
+	Hit->SetAPFlag(fAPflagvec);
 	fPixelCollection->insert(Hit);
 	fNCells = 0;
 	fNPhotoElectrons = 0;
+	fNDetected = 0;
 	fCells.clear();
 	fCellTime.clear();
 	fOCTflagvec.clear();
 	fDNflagvec.clear();
+	fAPflagvec.clear();
 
-	if(!fCmdDN) std::fill(firstStep.begin(), firstStep.end(), 0);
-	std::fill(isParent.begin(), isParent.end(), -1);
+	if(!fCmdDN) fCellState.Reset();
+	else fCellState.ClearLinks();
 }
 
 void PixelSD::clear(){}
@@ -3,6 +3,9 @@
 
 #include "PrimaryGeneratorAction.hh"
 #include "PGActionMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "PhaseSpaceSource.hh"
+#include "BeamSpectrum.hh"
 
 #include "G4RunManager.hh"
 #include "G4LogicalVolumeStore.hh"
@@ -10,17 +13,25 @@
 #include "G4LogicalVolume.hh"
 #include "G4Box.hh"
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4ParticleGun.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
+#include "BufferedRandom.hh"
 
 #include "TMath.h"
 
+#include <algorithm>
+
 
 PrimaryGeneratorAction::PrimaryGeneratorAction() : 
-    G4VUserPrimaryGeneratorAction(), fParticleGun(0), fDivergence(0){
+    G4VUserPrimaryGeneratorAction(), fParticleGun(0), fDivergence(0), fGeometryVersion(-1), 
+    fGunZ(0), fGunZDivergence(0), fBatchSize(1), fBatchIndex(0), 
+    fPhaseSpaceFile(""), fPhaseSpaceRecycle(false), fPhaseSpace(nullptr), 
+    fSavedParticle(nullptr), fSavedEnergy(0), 
+    fEnergySpectrum(nullptr), fAngularSpectrum(nullptr), fGunEnergy(0){
     G4int n_particle = 1;
     fParticleGun = new G4ParticleGun(n_particle);
 
@@ -32,6 +43,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction() :
     fParticleGun->SetParticleEnergy(2.2*MeV);
 
     //optical photon for OCT
+    fOpticalPhoton = G4ParticleTable::GetParticleTable()->FindParticle("opticalphoton");
 
     fOCTrun = false;
     fMessenger = new PGActionMessenger(this);
@@ -41,16 +53,113 @@ PrimaryGeneratorAction::PrimaryGeneratorAction() :
 PrimaryGeneratorAction::~PrimaryGeneratorAction(){
     delete fParticleGun;
     delete fMessenger;
+    delete fPhaseSpace;
+    delete fEnergySpectrum;
+    delete fAngularSpectrum;
+}
+
+/// Read the primaries from a phase-space file, "" for the gun. The gun
+/// gets back its particle, energy and direction when the file is dropped
+void PrimaryGeneratorAction::SetPhaseSpace(G4String fileName){
+    if(fPhaseSpaceFile == "" && fileName != ""){
+	fSavedParticle = fParticleGun->GetParticleDefinition();
+	fSavedEnergy = fParticleGun->GetParticleEnergy();
+	fSavedDirection = fParticleGun->GetParticleMomentumDirection();
+    }
+    else if(fPhaseSpaceFile != "" && fileName == ""){
+	fParticleGun->SetParticleDefinition(fSavedParticle);
+	fParticleGun->SetParticleEnergy(fSavedEnergy);
+	fParticleGun->SetParticleMomentumDirection(fSavedDirection);
+    }
+    fPhaseSpaceFile = fileName;
+    delete fPhaseSpace;
+    fPhaseSpace = nullptr;
+    fParticleGun->SetParticleTime(0);
+}
+
+void PrimaryGeneratorAction::SetPhaseSpaceRecycle(G4bool val){
+    fPhaseSpaceRecycle = val;
+    if(fPhaseSpace) fPhaseSpace->SetRecycle(val);
+}
+
+/// Kinetic energy spectrum from a file, "michel" or "" for the gun energy
+/// (the one set before the spectrum, the gun keeps the last sampled value)
+void PrimaryGeneratorAction::SetEnergySpectrum(G4String fileName){
+    BeamSpectrum* spectrum = nullptr;
+    if(fileName == "michel"){
+	spectrum = new BeamSpectrum();
+	spectrum->Michel();
+    }
+    else if(fileName != ""){
+	spectrum = new BeamSpectrum();
+	if(!spectrum->Load(fileName, 1)){
+	    delete spectrum;
+	    return;
+	}
+    }
+    if(!fEnergySpectrum && spectrum) fGunEnergy = fParticleGun->GetParticleEnergy();
+    else if(fEnergySpectrum && !spectrum) fParticleGun->SetParticleEnergy(fGunEnergy);
+    delete fEnergySpectrum;
+    fEnergySpectrum = spectrum;
+    fBatchIndex = fBatch.size();
+}
+
+/// Distribution of theta (phi uniform) or of theta and phi, "" for the
+/// divergence mode
+void PrimaryGeneratorAction::SetAngularSpectrum(G4String fileName, G4int dimension){
+    BeamSpectrum* spectrum = nullptr;
+    if(fileName != ""){
+	spectrum = new BeamSpectrum();
+	if(!spectrum->Load(fileName, dimension)){
+	    delete spectrum;
+	    return;
+	}
+    }
+    delete fAngularSpectrum;
+    fAngularSpectrum = spectrum;
+    fBatchIndex = fBatch.size();
 }
 
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
-    G4ParticleDefinition* particle = fParticleGun->GetParticleDefinition();
-	    
-    // In order to avoid dependence of PrimaryGeneratorAction
-    // on DetectorConstruction class we get world volume from G4LogicalVolumeStore.
+    // The engine has just been reseeded for this event: drop the numbers
+    // left from the previous one to keep every event reproducible
+    BufferedRandom::GetInstance()->Reset();
+
+    if(fPhaseSpaceFile != ""){
+	if(!fPhaseSpace) fPhaseSpace = new PhaseSpaceSource(fPhaseSpaceFile, fPhaseSpaceRecycle);
+	if(!fPhaseSpace->Next(fParticleGun)){
+	    G4Exception("PrimaryGeneratorAction::GeneratePrimaries", "PhaseSpace004", JustWarning, 
+			("End of the slice of " + fPhaseSpaceFile + ", the run is aborted").c_str());
+	    anEvent->SetEventAborted();
+	    G4RunManager::GetRunManager()->AbortRun(true);
+	    return;
+	}
+	fParticleGun->GeneratePrimaryVertex(anEvent);
+	return;
+    }
+
+    if(fGeometryVersion != DetectorConstruction::GetGeometryVersion()) UpdateGeometry();
+    if(fBatchIndex >= fBatch.size()) FillBatch();
+    const Vertex& vertex = fBatch[fBatchIndex++];
 
-    G4double world_size = 0;
+    // a null direction keeps the one of the gun
+    if(vertex.direction.mag2() > 0) fParticleGun->SetParticleMomentumDirection(vertex.direction);
+    if(vertex.energy >= 0) fParticleGun->SetParticleEnergy(vertex.energy);
+    if(fOCTrun){
+	    fParticleGun->SetParticleDefinition(fOpticalPhoton);
+	    fParticleGun->SetParticleEnergy(2.8*eV);
+    }
+    fParticleGun->SetParticlePosition(vertex.position);
+    fParticleGun->GeneratePrimaryVertex(anEvent);
+    anEvent->GetPrimaryVertex(anEvent->GetNumberOfPrimaryVertex() - 1)->SetWeight(vertex.weight);
+}
+
+/// Gun positions from the geometry, once per geometry version
+void PrimaryGeneratorAction::UpdateGeometry(){
+    // The volumes are taken from the stores, only the version of the
+    // geometry comes from DetectorConstruction
+    fGeometryVersion = DetectorConstruction::GetGeometryVersion();
     auto worldLV = G4LogicalVolumeStore::GetInstance()->GetVolume("World");
     auto scintLV = G4LogicalVolumeStore::GetInstance()->GetVolume("Element");
     auto scintPV = G4PhysicalVolumeStore::GetInstance()->GetVolume("Element");
@@ -58,31 +167,52 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent){
     G4Box* worldBox = dynamic_cast<G4Box*>(worldLV->GetSolid());
     G4Box* scintBox = dynamic_cast<G4Box*>(scintLV->GetSolid());
 
-    world_size = worldBox->GetXHalfLength();
+    fGunZ = worldBox->GetXHalfLength();
+    fGunZDivergence = scintPV->GetTranslation().z() + scintBox->GetZHalfLength();
+    fBatchIndex = fBatch.size();
+}
 
-    if(fDivergence > 0){
-	world_size = scintPV->GetTranslation().z() + scintBox->GetZHalfLength();
-	G4double phi = G4UniformRand() * 2 * TMath::Pi();
-	G4double theta = (G4UniformRand() - 1./2) * TMath::Pi();
-//	while (fabs(theta) > TMath::Pi()/2) theta = G4RandGauss::shoot(0, fDivergence);
-	fParticleGun->SetParticleMomentumDirection(G4ThreeVector(sin(theta)*cos(phi), sin(theta)*sin(phi), -cos(theta)));
-    }
-    else if (fDivergence == 0){
-	fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0,0,-1));
-    }
-    // Set gun position
-    if(!fOCTrun){
-	    fParticleGun->SetParticleDefinition(particle);
-	    fParticleGun->SetParticlePosition(G4ThreeVector(0, 0, world_size)); //0.5*scintBox->GetYHalfLength()
-	    fParticleGun->GeneratePrimaryVertex(anEvent);
-    }
-    else{
-	    particle = G4ParticleTable::GetParticleTable()->FindParticle("opticalphoton");
-	    fParticleGun->SetParticleDefinition(particle);
-	    fParticleGun->SetParticlePosition(G4ThreeVector(G4UniformRand() * 1.3 - 1.3*0.5,G4UniformRand() * 1.3 - 1.3*0.5, world_size));
-	    fParticleGun->SetParticleEnergy(2.8*eV);
-	    fParticleGun->GeneratePrimaryVertex(anEvent);
+/// Vertices of the next events. With one event per batch the numbers are
+/// drawn from the seeds of the event itself; with N > 1 the N vertices all
+/// come from the engine state of the first event of the batch, the seeds of
+/// the others are not used, and in MT which events share a batch depends on
+/// the scheduling of the threads: the vertices are then not reproducible
+/// event by event.
+void PrimaryGeneratorAction::FillBatch(){
+    BufferedRandom* random = BufferedRandom::GetInstance();
+    fBatch.resize(std::max(fBatchSize, 1));
+    G4double world_size = (fDivergence > 0 || fAngularSpectrum) ? fGunZDivergence : fGunZ;
+    for(auto& vertex : fBatch){
+	vertex.weight = 1;
+	if(fAngularSpectrum){
+	    G4double theta, phi;
+	    G4double u = random->Flat();
+	    G4double v = (fAngularSpectrum->GetDimension() == 2) ? random->Flat() : 0;
+	    vertex.weight *= fAngularSpectrum->Sample(u, v, theta, phi);
+	    if(fAngularSpectrum->GetDimension() == 1) phi = random->Flat() * 360;
+	    theta *= deg;
+	    phi *= deg;
+	    vertex.direction = G4ThreeVector(sin(theta)*cos(phi), sin(theta)*sin(phi), -cos(theta));
+	}
+	else if(fDivergence > 0){
+	    G4double phi = random->Flat() * 2 * TMath::Pi();
+	    G4double theta = (random->Flat() - 1./2) * TMath::Pi();
+//	    while (fabs(theta) > TMath::Pi()/2) theta = G4RandGauss::shoot(0, fDivergence);
+	    vertex.direction = G4ThreeVector(sin(theta)*cos(phi), sin(theta)*sin(phi), -cos(theta));
+	}
+	else if(fDivergence == 0) vertex.direction = G4ThreeVector(0,0,-1);
+	else vertex.direction = G4ThreeVector();
+
+	// Set gun position
+	if(!fOCTrun) vertex.position = G4ThreeVector(0, 0, world_size); //0.5*scintBox->GetYHalfLength()
+	else vertex.position = G4ThreeVector(random->Flat() * 1.3 - 1.3*0.5,random->Flat() * 1.3 - 1.3*0.5, world_size);
+
+	vertex.energy = -1;
+	if(fEnergySpectrum){
+	    G4double energy, y;
+	    vertex.weight *= fEnergySpectrum->Sample(random->Flat(), 0, energy, y);
+	    vertex.energy = energy * MeV;
+	}
     }
+    fBatchIndex = 0;
 }
-
-
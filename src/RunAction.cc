@@ -4,6 +4,11 @@
 #include "RunAction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "RunActionMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "PixelDigitizer.hh"
+#include "DigitizerIO.hh"
+#include "StartupCache.hh"
+#include "SteppingAction.hh"
 
 #include "TFile.h"
 #include "TTree.h"
@@ -11,16 +16,19 @@
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
+#include "G4DigiManager.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
 #include "G4GenericMessenger.hh"
 
 RunAction::RunAction() : 
-	G4UserRunAction(), fData(nullptr), fTree(nullptr), fCmdOCT(false), 
-	fCmdDN(false), fCmdPhotons(1), fCmdTracks(1), fRight(0), fLeft(0), 
+	G4UserRunAction(), fData(nullptr), fTree(nullptr), fWaves(nullptr), fWaveWriter(nullptr), fCmdOCT(false), 
+	fCmdDN(false), fCmdAP(false), fCmdRecovery(false), fCmdSaturation(false), fCmdDigitize(false), 
+	fDigiThreshold(0.1), fDigiLatency(1*CLHEP::microsecond), fDigiSmearing(""), fDigiChannelMap(""), 
+	fDigiCFDFraction(0.2), fDigiNoiseRMS(0), fDigiNoiseBandwidth(0.2), fDigiNoiseSpectrum(""), fCmdPhotons(1), fCmdTracks(1), fRight(0), fLeft(0), 
 	fDown(0), fUp(0), fBack(0), fFront(0), fSiPM(0), fGunTime(0), fDNTime(0), 
-	fGunTimeMean(1/(1.9e9*CLHEP::hertz)), fDNTimeMean(1/(90*CLHEP::kilohertz)), 
+	fGunTimeMean(1/(1.9e9*CLHEP::hertz)), fDNTimeMean(1/(90*CLHEP::kilohertz)), fDecayTime(0), fWeight(1), 
 	fName("./data.root"){
 	//DefineCommands();
 	fMessenger = new RunActionMessenger(this);
@@ -31,6 +39,19 @@ RunAction::~RunAction(){
 }
 
 void RunAction::BeginOfRunAction(const G4Run*){
+	// the geometry is already built: with a group of detector changes left
+	// open the run would silently use the old one
+	const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+	if(IsMaster() && detector && detector->HasOpenChanges()){
+		G4Exception("RunAction::BeginOfRunAction", "Geom003", RunMustBeAborted, 
+			    "/Element/det/begin without /Element/det/commit, the run is aborted: commit the changes before /run/beamOn");
+	}
+	// the saturation-only response has no cells to digitize
+	if(fCmdSaturation && fCmdDigitize){
+		if(IsMaster()) G4Exception("RunAction::BeginOfRunAction", "Digi004", JustWarning, 
+					   "/Element/det/Digitize needs /Element/det/SiPMResponse full, the digitization is disabled");
+		fCmdDigitize = false;
+	}
 	fGunTime = 0;
 	fDNTime = 0;
 	this->AdvanceDNTime();
@@ -72,12 +93,29 @@ void RunAction::BeginOfRunAction(const G4Run*){
 
 	fTree->Branch("NCells", &fNCells);
 	fTree->Branch("NPhotoElectrons", &fNPhotoElectrons);
-	fTree->Branch("Cells", &fCells);
-	fTree->Branch("CellTime", &fCellTime);
-	fTree->Branch("OCTflag", &fOCTflag);
-	fTree->Branch("DNflag", &fDNflag);
+	// The saturation-only SiPM response has no per-cell information, with the
+	// digitization the cells are replaced by the signals
+	if(!fCmdSaturation && !fCmdDigitize){
+		fTree->Branch("Cells", &fCells);
+		fTree->Branch("CellTime", &fCellTime);
+		fTree->Branch("OCTflag", &fOCTflag);
+		fTree->Branch("DNflag", &fDNflag);
+		fTree->Branch("APflag", &fAPflag);
+	}
 	fTree->Branch("GunTime", &fGunTime);
 	fTree->Branch("DecayTime", &fDecayTime);
+	fTree->Branch("Weight", &fWeight);
+
+	PixelDigitizer* digitizer = (PixelDigitizer*) G4DigiManager::GetDMpointer()->FindDigitizerModule("PixelDigitizer");
+	if(fCmdDigitize && digitizer){
+		fWaves = new TTree("waves", "signals");
+		fWaveWriter = new WaveWriter(fWaves);
+		digitizer->BeginOfRun(this);
+	}
+}
+
+void RunAction::FillWave(const WaveSignal& signal){
+	if(fWaveWriter) fWaveWriter->Fill(signal);
 }
 
 
@@ -85,7 +123,21 @@ void RunAction::EndOfRunAction(const G4Run*){
 	fData->cd();
 	//fTree->Print();
 	fTree->Write();
+	if(fWaves){
+		PixelDigitizer* digitizer = (PixelDigitizer*) G4DigiManager::GetDMpointer()->FindDigitizerModule("PixelDigitizer");
+		for(auto& signal : digitizer->EndOfRun()) fWaveWriter->Fill(signal);
+		fWaves->Write("waves", TObject::kOverwrite);
+		delete fWaveWriter;
+		fWaveWriter = nullptr;
+		fWaves = nullptr;
+	}
 	fData->Close();
+	// the workers end their runs before the master
+	const SteppingAction* stepping = static_cast<const SteppingAction*>(G4RunManager::GetRunManager()->GetUserSteppingAction());
+	if(stepping) const_cast<SteppingAction*>(stepping)->EndOfRun();
+	if(IsMaster()) SteppingAction::PrintRegionSteps();
+	// the tables are complete once a run is done
+	if(IsMaster()) StartupCache::GetInstance()->StorePhysicsTables();
 }
 
 
@@ -11,6 +11,7 @@
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADouble.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 
 RunActionMessenger::RunActionMessenger(RunAction* action) : G4UImessenger(), fRunAction(action){
@@ -45,6 +46,79 @@ RunActionMessenger::RunActionMessenger(RunAction* action) : G4UImessenger(), fRu
 	fCmdDN->SetParameterName("DN", false);
 	fCmdDN->AvailableForStates(G4State_Idle);
 
+	fCmdAP = new G4UIcmdWithABool("/Element/det/AP", this);
+	fCmdAP->SetGuidance("Activate afterpulsing in SiPMs");
+	fCmdAP->SetGuidance("The release delay (APtau) starts at the end of the 20 ns hold-off, the charge follows the cell recovery (/Element/det/Recovery)");
+	fCmdAP->SetParameterName("AP", false);
+	fCmdAP->AvailableForStates(G4State_Idle);
+
+	fCmdRecovery = new G4UIcmdWithABool("/Element/det/Recovery", this);
+	fCmdRecovery->SetGuidance("Activate the recovery of the SiPM cells (RecoveryTime of the catalogue)");
+	fCmdRecovery->SetGuidance("A cell fired again after the 20 ns hold-off fires with the probability and the charge of its recovered overvoltage, else at full charge");
+	fCmdRecovery->SetParameterName("recovery", false);
+	fCmdRecovery->AvailableForStates(G4State_Idle);
+
+	fCmdResponse = new G4UIcmdWithAString("/Element/det/SiPMResponse", this);
+	fCmdResponse->SetGuidance("Choose the SiPM response model.");
+	fCmdResponse->SetGuidance("full: per-cell bookkeeping with dead time, DN, OCT and afterpulses.");
+	fCmdResponse->SetGuidance("saturation: analytic saturation of the detected photons, only NCells and NPhotoElectrons are saved.");
+	fCmdResponse->SetParameterName("response", false);
+	fCmdResponse->SetCandidates("full saturation");
+	fCmdResponse->AvailableForStates(G4State_Idle);
+
+	fCmdDigitize = new G4UIcmdWithABool("/Element/det/Digitize", this);
+	fCmdDigitize->SetGuidance("Digitize the SiPM signals during the simulation.");
+	fCmdDigitize->SetGuidance("The waves tree is written instead of the per-cell branches.");
+	fCmdDigitize->SetGuidance("Needs the full SiPM response (/Element/det/SiPMResponse full).");
+	fCmdDigitize->SetParameterName("digitize", false);
+	fCmdDigitize->AvailableForStates(G4State_Idle);
+
+	fCmdDigiThreshold = new G4UIcmdWithADouble("/Element/det/DigiThreshold", this);
+	fCmdDigiThreshold->SetGuidance("Set the discriminator threshold of the digitizer (single cell amplitude units).");
+	fCmdDigiThreshold->SetParameterName("threshold", false);
+	fCmdDigiThreshold->SetRange("threshold > 0");
+	fCmdDigiThreshold->AvailableForStates(G4State_Idle);
+
+	fCmdDigiLatency = new G4UIcmdWithADoubleAndUnit("/Element/det/DigiLatency", this);
+	fCmdDigiLatency->SetGuidance("Set how long the fired cells are held back before digitization.");
+	fCmdDigiLatency->SetGuidance("It must be longer than the latest cell of an event after its gun time.");
+	fCmdDigiLatency->SetParameterName("latency", false);
+	fCmdDigiLatency->SetUnitCategory("Time");
+	fCmdDigiLatency->AvailableForStates(G4State_Idle);
+
+	fCmdDigiSmearing = new G4UIcmdWithAString("/Element/det/DigiSmearing", this);
+	fCmdDigiSmearing->SetGuidance("Set the file with the gain smearing parameters (as pars.txt), none for no smearing.");
+	fCmdDigiSmearing->SetParameterName("file", false);
+	fCmdDigiSmearing->AvailableForStates(G4State_Idle);
+
+	fCmdDigiChannelMap = new G4UIcmdWithAString("/Element/det/DigiChannelMap", this);
+	fCmdDigiChannelMap->SetGuidance("Set the readout channel map file, none for one channel per element.");
+	fCmdDigiChannelMap->SetParameterName("file", false);
+	fCmdDigiChannelMap->AvailableForStates(G4State_Idle);
+
+	fCmdDigiCFDFraction = new G4UIcmdWithADouble("/Element/det/DigiCFDFraction", this);
+	fCmdDigiCFDFraction->SetGuidance("Set the constant fraction of the TimeCFD of the signals (default 0.2).");
+	fCmdDigiCFDFraction->SetParameterName("fraction", false);
+	fCmdDigiCFDFraction->SetRange("fraction > 0 && fraction < 1");
+	fCmdDigiCFDFraction->AvailableForStates(G4State_Idle);
+
+	fCmdDigiNoise = new G4UIcmdWithADouble("/Element/det/DigiNoise", this);
+	fCmdDigiNoise->SetGuidance("Set the rms of the baseline noise (single cell amplitude units), 0 for no noise.");
+	fCmdDigiNoise->SetParameterName("rms", false);
+	fCmdDigiNoise->SetRange("rms >= 0");
+	fCmdDigiNoise->AvailableForStates(G4State_Idle);
+
+	fCmdDigiNoiseBandwidth = new G4UIcmdWithADouble("/Element/det/DigiNoiseBandwidth", this);
+	fCmdDigiNoiseBandwidth->SetGuidance("Set the bandwidth (GHz) of the one-pole noise spectrum (default 0.2).");
+	fCmdDigiNoiseBandwidth->SetParameterName("bandwidth", false);
+	fCmdDigiNoiseBandwidth->SetRange("bandwidth > 0");
+	fCmdDigiNoiseBandwidth->AvailableForStates(G4State_Idle);
+
+	fCmdDigiNoiseSpectrum = new G4UIcmdWithAString("/Element/det/DigiNoiseSpectrum", this);
+	fCmdDigiNoiseSpectrum->SetGuidance("Set the file of the noise spectrum (frequency in GHz, density), none for the one-pole spectrum.");
+	fCmdDigiNoiseSpectrum->SetParameterName("file", false);
+	fCmdDigiNoiseSpectrum->AvailableForStates(G4State_Idle);
+
 	fCmdGunTime = new G4UIcmdWithADoubleAndUnit("/Primary/Rate", this);
 	fCmdGunTime->SetGuidance("Set beam rate.");
 	fCmdGunTime->SetParameterName("rate", false);
@@ -58,6 +132,18 @@ RunActionMessenger::~RunActionMessenger(){
 	delete fCmdFileName;
 	delete fCmdOCT;
 	delete fCmdDN;
+	delete fCmdAP;
+	delete fCmdRecovery;
+	delete fCmdResponse;
+	delete fCmdDigitize;
+	delete fCmdDigiThreshold;
+	delete fCmdDigiLatency;
+	delete fCmdDigiSmearing;
+	delete fCmdDigiChannelMap;
+	delete fCmdDigiCFDFraction;
+	delete fCmdDigiNoise;
+	delete fCmdDigiNoiseBandwidth;
+	delete fCmdDigiNoiseSpectrum;
 	delete fCmdPhotons;
 	delete fCmdTracks;
 	delete fAnalysisDirectory;
@@ -73,6 +159,42 @@ void RunActionMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
 	else if (command == fCmdDN){
 		fRunAction->SetCmdDN(fCmdDN->GetNewBoolValue(newValue));
 	}
+	else if (command == fCmdAP){
+		fRunAction->SetCmdAP(fCmdAP->GetNewBoolValue(newValue));
+	}
+	else if (command == fCmdRecovery){
+		fRunAction->SetCmdRecovery(fCmdRecovery->GetNewBoolValue(newValue));
+	}
+	else if (command == fCmdResponse){
+		fRunAction->SetCmdSaturation(newValue == "saturation");
+	}
+	else if (command == fCmdDigitize){
+		fRunAction->SetCmdDigitize(fCmdDigitize->GetNewBoolValue(newValue));
+	}
+	else if (command == fCmdDigiThreshold){
+		fRunAction->SetDigiThreshold(fCmdDigiThreshold->GetNewDoubleValue(newValue));
+	}
+	else if (command == fCmdDigiLatency){
+		fRunAction->SetDigiLatency(fCmdDigiLatency->GetNewDoubleValue(newValue));
+	}
+	else if (command == fCmdDigiSmearing){
+		fRunAction->SetDigiSmearing(newValue == "none" ? "" : newValue);
+	}
+	else if (command == fCmdDigiChannelMap){
+		fRunAction->SetDigiChannelMap(newValue == "none" ? "" : newValue);
+	}
+	else if (command == fCmdDigiCFDFraction){
+		fRunAction->SetDigiCFDFraction(fCmdDigiCFDFraction->GetNewDoubleValue(newValue));
+	}
+	else if (command == fCmdDigiNoise){
+		fRunAction->SetDigiNoise(fCmdDigiNoise->GetNewDoubleValue(newValue));
+	}
+	else if (command == fCmdDigiNoiseBandwidth){
+		fRunAction->SetDigiNoiseBandwidth(fCmdDigiNoiseBandwidth->GetNewDoubleValue(newValue));
+	}
+	else if (command == fCmdDigiNoiseSpectrum){
+		fRunAction->SetDigiNoiseSpectrum(newValue == "none" ? "" : newValue);
+	}
 	else if (command == fCmdPhotons){
 		fRunAction->SetCmdPhotons(fCmdPhotons->GetNewIntValue(newValue));
 	}
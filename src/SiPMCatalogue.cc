@@ -0,0 +1,309 @@
+/// \file  SiPMCatalogue.cc
+/// \brief Implementation of the SiPMCatalogue class
+
+#include "SiPMCatalogue.hh"
+#include "StartupCache.hh"
+
+#include "G4AutoLock.hh"
+#include "G4Exception.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	G4Mutex catalogueMutex = G4MUTEX_INITIALIZER;
+
+	const char kMagic[8] = {'S', 'i', 'P', 'M', 'C', 'A', 'T', '1'};
+	const G4int kGridSize = 1024;
+
+	// Two columns tables as in ../tables
+	void ReadTable(G4String name, std::vector<G4double>& x, std::vector<G4double>& y){
+		std::ifstream myfile(name);
+		if(!myfile.is_open()){
+			G4Exception("SiPMCatalogue::ReadTable", "SiPM001", FatalException, ("Cannot open " + name).c_str());
+		}
+		G4double tx, ty;
+		while(myfile >> tx >> ty){
+			x.push_back(tx);
+			y.push_back(ty);
+		}
+	}
+
+	// Value of the nearest tabulated point
+	G4double Nearest(const std::vector<G4double>& x, const std::vector<G4double>& y, G4double val){
+		auto it = std::lower_bound(x.begin(), x.end(), val);
+		if(it == x.begin()) return y.front();
+		if(it == x.end()) return y.back();
+		size_t i = it - x.begin();
+		return (x[i] - val < val - x[i - 1]) ? y[i] : y[i - 1];
+	}
+
+	uint64_t FNV1a(uint64_t hash, const char* data, size_t n){
+		for(size_t i = 0; i < n; i++){
+			hash ^= (unsigned char) data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	void WriteString(std::ofstream& out, const G4String& s){
+		uint32_t n = s.size();
+		out.write((const char*) &n, sizeof(n));
+		out.write(s.data(), n);
+	}
+
+	G4String ReadString(std::ifstream& in){
+		uint32_t n = 0;
+		in.read((char*) &n, sizeof(n));
+		std::string s(n, ' ');
+		in.read(&s[0], n);
+		return s;
+	}
+
+	template<typename T> void WritePod(std::ofstream& out, const T& val){
+		out.write((const char*) &val, sizeof(T));
+	}
+
+	template<typename T> void ReadPod(std::ifstream& in, T& val){
+		in.read((char*) &val, sizeof(T));
+	}
+
+	void WriteVector(std::ofstream& out, const std::vector<G4double>& v){
+		uint32_t n = v.size();
+		WritePod(out, n);
+		out.write((const char*) v.data(), n * sizeof(G4double));
+	}
+
+	void ReadVector(std::ifstream& in, std::vector<G4double>& v){
+		uint32_t n = 0;
+		ReadPod(in, n);
+		v.resize(n);
+		in.read((char*) v.data(), n * sizeof(G4double));
+	}
+}
+
+SiPMCatalogue::SiPMCatalogue() : fFileName("../tables/SiPM_models.txt"), fDirectory("../tables/"), fLoaded(false){}
+
+SiPMCatalogue::~SiPMCatalogue(){}
+
+SiPMCatalogue* SiPMCatalogue::GetInstance(){
+	static SiPMCatalogue instance;
+	return &instance;
+}
+
+/// Select another catalogue, it is read at the next device request
+void SiPMCatalogue::Load(G4String fileName){
+	G4AutoLock lock(&catalogueMutex);
+	fFileName = fileName;
+	size_t slash = fileName.find_last_of('/');
+	fDirectory = (slash == std::string::npos) ? "" : fileName.substr(0, slash + 1);
+	fLoaded = false;
+	fDevices.clear();
+	fIndex.clear();
+}
+
+const SiPMDevice* SiPMCatalogue::GetDevice(G4String name){
+	G4AutoLock lock(&catalogueMutex);
+	if(!fLoaded){
+		std::vector<SiPMDevice> devices;
+		Parse(devices);
+		uint64_t hash = Hash(devices);
+		if(!ReadBinary(BinaryName(), hash)){
+			fDevices = devices;
+			for(auto& device : fDevices) Derive(device);
+			WriteBinary(BinaryName(), hash);
+		}
+		for(size_t i = 0; i < fDevices.size(); i++) fIndex[fDevices[i].name] = i;
+		fLoaded = true;
+		G4cout << "SiPMCatalogue: " << fDevices.size() << " devices from " << fFileName << G4endl;
+	}
+	auto it = fIndex.find(name);
+	if(it == fIndex.end()) return nullptr;
+	return &fDevices[it->second];
+}
+
+std::vector<G4String> SiPMCatalogue::GetDeviceNames(){
+	GetDevice("");
+	std::vector<G4String> names;
+	for(auto& device : fDevices) names.push_back(device.name);
+	return names;
+}
+
+void SiPMCatalogue::Parse(std::vector<SiPMDevice>& devices){
+	std::ifstream myfile(fFileName);
+	if(!myfile.is_open()){
+		G4Exception("SiPMCatalogue::Parse", "SiPM001", FatalException, ("Cannot open " + fFileName).c_str());
+	}
+	std::string line;
+	while(std::getline(myfile, line)){
+		if(line.empty() || line[0] == '#') continue;
+		std::istringstream is(line);
+		SiPMDevice device;
+		std::string name, window;
+		G4double DN = 0, recovery = 0, tau = 0;
+		is >> name >> device.pitch >> device.nbPixelsX >> device.nbPixelsY >> device.fillFactor
+		   >> device.gain >> device.overVoltage >> DN >> window >> device.OCTFactor
+		   >> recovery >> device.afterpulseProb >> tau;
+		for(G4int i = 0; i < 4; i++) is >> device.tables[i];
+		if(is.fail()){
+			G4Exception("SiPMCatalogue::Parse", "SiPM002", JustWarning, ("Skipping malformed line: " + line).c_str());
+			continue;
+		}
+		device.name = name;
+		device.pitch *= um;
+		device.darkNoiseRate = DN * kilohertz;
+		device.window = (window == "CS") ? 0 : 1;
+		device.recoveryTime = recovery * ns;
+		device.afterpulseTau = tau * ns;
+		devices.push_back(device);
+	}
+}
+
+/// Tabulate the device tables on uniform grids
+void SiPMCatalogue::Derive(SiPMDevice& device){
+	std::vector<G4double> x, y;
+
+	// Detection efficiency, the table is in wavelength
+	ReadTable(fDirectory + device.tables[0], x, y);
+	std::vector<G4double> energy, eff;
+	for(G4int i = x.size() - 1; i >= 0; i--){
+		energy.push_back(1239.84197 / x[i]);
+		eff.push_back(y[i]);
+	}
+	// outside the table within half a spacing from the edges the efficiency is zero
+	G4int N = energy.size();
+	device.eMin = energy.front() - 0.5 * (energy[1] - energy[0]);
+	G4double eMax = energy.back() + 0.5 * (energy[N - 1] - energy[N - 2]);
+	device.eStep = (eMax - device.eMin) / (kGridSize - 1);
+	device.detEff.resize(kGridSize);
+	for(G4int i = 0; i < kGridSize; i++){
+		G4double e = device.eMin + i * device.eStep;
+		device.detEff[i] = (e <= energy.front() || e >= energy.back()) ? 0 : Nearest(energy, eff, e);
+	}
+
+	// Voltage dependent quantities on a common overvoltage grid
+	std::vector<G4double> vx[3], vy[3];
+	G4double vMin = 1e9, vMax = -1e9;
+	for(G4int k = 0; k < 3; k++){
+		ReadTable(fDirectory + device.tables[k + 1], vx[k], vy[k]);
+		vMin = std::min(vMin, vx[k].front());
+		vMax = std::max(vMax, vx[k].back());
+	}
+	device.vMin = vMin;
+	device.vStep = (vMax - vMin) / (kGridSize - 1);
+	std::vector<G4double>* out[3] = {&device.detEffGain, &device.OCTGain, &device.photonGain};
+	for(G4int k = 0; k < 3; k++){
+		out[k]->resize(kGridSize);
+		for(G4int i = 0; i < kGridSize; i++) (*out[k])[i] = Nearest(vx[k], vy[k], vMin + i * device.vStep);
+	}
+}
+
+/// Hash of the names, sizes and modification times of the catalogue and of
+/// all the tables it refers to
+uint64_t SiPMCatalogue::Hash(const std::vector<SiPMDevice>& devices){
+	uint64_t hash = 14695981039346656037ULL;
+	std::vector<G4String> files = {fFileName};
+	for(auto& device : devices) for(G4int i = 0; i < 4; i++) files.push_back(fDirectory + device.tables[i]);
+	for(auto& name : files){
+		struct stat info;
+		int64_t id[3] = {-1, 0, 0};
+		if(stat(name.c_str(), &info) == 0){
+			id[0] = info.st_size;
+			id[1] = info.st_mtim.tv_sec;
+			id[2] = info.st_mtim.tv_nsec;
+		}
+		hash = FNV1a(hash, name.c_str(), name.size() + 1);
+		hash = FNV1a(hash, (const char*) id, sizeof(id));
+	}
+	return hash;
+}
+
+/// In the start up cache directory when there is one
+G4String SiPMCatalogue::BinaryName(){
+	StartupCache* cache = StartupCache::GetInstance();
+	if(!cache->IsEnabled()) return fFileName + ".bin";
+	return cache->GetDirectory() + fFileName.substr(fDirectory.size()) + ".bin";
+}
+
+G4bool SiPMCatalogue::ReadBinary(G4String name, uint64_t hash){
+	std::ifstream in(name, std::ios::binary);
+	if(!in.is_open()) return false;
+	char magic[8];
+	uint64_t fileHash = 0;
+	uint32_t n = 0;
+	in.read(magic, 8);
+	ReadPod(in, fileHash);
+	if(!in || !std::equal(magic, magic + 8, kMagic) || fileHash != hash) return false;
+	ReadPod(in, n);
+	std::vector<SiPMDevice> devices(n);
+	for(auto& device : devices){
+		device.name = ReadString(in);
+		ReadPod(in, device.pitch);
+		ReadPod(in, device.nbPixelsX);
+		ReadPod(in, device.nbPixelsY);
+		ReadPod(in, device.fillFactor);
+		ReadPod(in, device.gain);
+		ReadPod(in, device.overVoltage);
+		ReadPod(in, device.darkNoiseRate);
+		ReadPod(in, device.window);
+		ReadPod(in, device.OCTFactor);
+		ReadPod(in, device.recoveryTime);
+		ReadPod(in, device.afterpulseProb);
+		ReadPod(in, device.afterpulseTau);
+		for(G4int i = 0; i < 4; i++) device.tables[i] = ReadString(in);
+		ReadPod(in, device.eMin);
+		ReadPod(in, device.eStep);
+		ReadVector(in, device.detEff);
+		ReadPod(in, device.vMin);
+		ReadPod(in, device.vStep);
+		ReadVector(in, device.detEffGain);
+		ReadVector(in, device.OCTGain);
+		ReadVector(in, device.photonGain);
+	}
+	if(!in) return false;
+	fDevices = devices;
+	return true;
+}
+
+/// Written aside and renamed, the concurrent jobs only see complete files
+void SiPMCatalogue::WriteBinary(G4String name, uint64_t hash){
+	G4String temporary = name + ".tmp" + std::to_string(getpid());
+	std::ofstream out(temporary, std::ios::binary);
+	if(!out.is_open()) return; // read-only area, the tables will be derived again next time
+	out.write(kMagic, 8);
+	WritePod(out, hash);
+	WritePod(out, uint32_t(fDevices.size()));
+	for(auto& device : fDevices){
+		WriteString(out, device.name);
+		WritePod(out, device.pitch);
+		WritePod(out, device.nbPixelsX);
+		WritePod(out, device.nbPixelsY);
+		WritePod(out, device.fillFactor);
+		WritePod(out, device.gain);
+		WritePod(out, device.overVoltage);
+		WritePod(out, device.darkNoiseRate);
+		WritePod(out, device.window);
+		WritePod(out, device.OCTFactor);
+		WritePod(out, device.recoveryTime);
+		WritePod(out, device.afterpulseProb);
+		WritePod(out, device.afterpulseTau);
+		for(G4int i = 0; i < 4; i++) WriteString(out, device.tables[i]);
+		WritePod(out, device.eMin);
+		WritePod(out, device.eStep);
+		WriteVector(out, device.detEff);
+		WritePod(out, device.vMin);
+		WritePod(out, device.vStep);
+		WriteVector(out, device.detEffGain);
+		WriteVector(out, device.OCTGain);
+		WriteVector(out, device.photonGain);
+	}
+	out.close();
+	if(!out || std::rename(temporary.c_str(), name.c_str()) != 0) std::remove(temporary.c_str());
+}
+
+
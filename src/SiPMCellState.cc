@@ -0,0 +1,34 @@
+/// \file  SiPMCellState.cc
+/// \brief Implementation of the SiPMCellState class
+
+#include "SiPMCellState.hh"
+
+SiPMCellState::SiPMCellState() : fNbOfCells(0), fDeadTime(0), fRecoveryTime(0){}
+
+SiPMCellState::~SiPMCellState(){}
+
+void SiPMCellState::Resize(G4int nCells){
+	fNbOfCells = nCells;
+	fFired.assign((nCells + 63) / 64, 0);
+	fCell.assign(nCells, Cell{0, -1});
+	fFiredList.clear();
+	fFiredList.reserve(nCells);
+	fLinked.clear();
+}
+
+/// Forget the OCT parent-child links set during the event
+void SiPMCellState::ClearLinks(){
+	for(G4int cell : fLinked) fCell[cell].child = -1;
+	fLinked.clear();
+}
+
+/// Bring back to the idle state only the cells that have fired
+void SiPMCellState::Reset(){
+	for(G4int cell : fFiredList){
+		fFired[cell >> 6] = 0;
+		fCell[cell].time = 0;
+	}
+	fFiredList.clear();
+	ClearLinks();
+}
+
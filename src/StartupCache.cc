@@ -0,0 +1,190 @@
+/// \file  StartupCache.cc
+/// \brief Implementation of the StartupCache class
+
+#include "StartupCache.hh"
+
+#include "G4RunManager.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4StateManager.hh"
+#include "G4VStateDependent.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Version.hh"
+#include "G4Exception.hh"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <set>
+#include <utility>
+#include <cstdio>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+	uint64_t FNV1a(uint64_t hash, const void* data, size_t n){
+		for(size_t i = 0; i < n; i++){
+			hash ^= ((const unsigned char*) data)[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// The tables are built at the transition from Idle to Init of the run
+	// initialisation, after the geometry
+	class RunInitialisationNotifier : public G4VStateDependent{
+		public:
+			virtual G4bool Notify(G4ApplicationState requestedState){
+				if(requestedState == G4State_Init && G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle){
+					StartupCache::GetInstance()->SelectPhysicsTables();
+				}
+				return true;
+			}
+	};
+
+	// Material and cuts of the volumes under volume, cuts being the ones of
+	// the region of volume
+	void Couples(G4LogicalVolume* volume, const G4ProductionCuts* cuts, const std::map<G4LogicalVolume*, G4Region*>& roots,
+		     std::set<std::pair<G4LogicalVolume*, const G4ProductionCuts*> >& visited, std::set<G4String>& couples){
+		auto root = roots.find(volume);
+		if(root != roots.end() && root->second->GetProductionCuts()) cuts = root->second->GetProductionCuts();
+		if(!visited.insert(std::make_pair(volume, cuts)).second) return;
+		std::ostringstream couple;
+		couple << volume->GetMaterial()->GetName();
+		for(G4int i = 0; i < 4; i++) couple << " " << cuts->GetProductionCut(i);
+		couples.insert(couple.str());
+		for(size_t i = 0; i < volume->GetNoDaughters(); i++){
+			Couples(volume->GetDaughter(i)->GetLogicalVolume(), cuts, roots, visited, couples);
+		}
+	}
+
+	void RemoveDirectory(G4String name){
+		if(DIR* dir = opendir(name.c_str())){
+			while(dirent* entry = readdir(dir)){
+				G4String file = entry->d_name;
+				if(file != "." && file != "..") std::remove((name + "/" + file).c_str());
+			}
+			closedir(dir);
+		}
+		rmdir(name.c_str());
+	}
+}
+
+StartupCache::StartupCache() : fDirectory(""), fPhysicsDirectory(""), fPhysicsConfiguration(""), fStorePhysics(false), fNotifier(false){}
+
+StartupCache::~StartupCache(){}
+
+StartupCache* StartupCache::GetInstance(){
+	static StartupCache instance;
+	return &instance;
+}
+
+/// Use the cache of directory ("" to disable), the physics tables are
+/// chosen before each run
+void StartupCache::SetDirectory(G4String directory){
+	fDirectory = directory;
+	fPhysicsDirectory = "";
+	fStorePhysics = false;
+	if(directory == ""){
+		G4VUserPhysicsList* physics = const_cast<G4VUserPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+		if(physics) physics->ResetPhysicsTableRetrieved();
+		return;
+	}
+	if(directory.back() != '/') fDirectory += "/";
+	mkdir(fDirectory.c_str(), 0755);
+	// owned by the state manager
+	if(!fNotifier) new RunInitialisationNotifier();
+	fNotifier = true;
+}
+
+G4String StartupCache::OverlapFile(uint64_t hash){
+	std::ostringstream name;
+	name << fDirectory << "overlaps-" << std::hex << hash;
+	return name.str();
+}
+
+G4int StartupCache::GetOverlapVerdict(uint64_t hash){
+	if(!IsEnabled()) return -1;
+	std::ifstream myfile(OverlapFile(hash));
+	G4int verdict = -1;
+	if(!(myfile >> verdict) || verdict < 0 || verdict > 1) return -1;
+	return verdict;
+}
+
+void StartupCache::SetOverlapVerdict(uint64_t hash, G4bool overlaps){
+	if(!IsEnabled()) return;
+	G4String name = OverlapFile(hash);
+	G4String temporary = name + ".tmp" + std::to_string(getpid());
+	{
+		std::ofstream myfile(temporary);
+		myfile << (overlaps ? 1 : 0) << std::endl;
+	}
+	if(std::rename(temporary.c_str(), name.c_str()) != 0) std::remove(temporary.c_str());
+}
+
+/// Hash of the material-cuts couples of the geometry
+uint64_t StartupCache::CouplesHash(){
+	G4VPhysicalVolume* world = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume();
+	if(!world) return 0;
+	// the volumes are assigned to the regions later in the run initialisation,
+	// the regions are followed from their root volumes
+	std::map<G4LogicalVolume*, G4Region*> roots;
+	for(G4Region* region : *G4RegionStore::GetInstance()){
+		auto it = region->GetRootLogicalVolumeIterator();
+		for(size_t i = 0; i < region->GetNumberOfRootVolumes(); i++, it++) roots[*it] = region;
+	}
+	std::set<std::pair<G4LogicalVolume*, const G4ProductionCuts*> > visited;
+	std::set<G4String> couples;
+	Couples(world->GetLogicalVolume(), G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts(), roots, visited, couples);
+	uint64_t hash = 14695981039346656037ULL;
+	for(const G4String& couple : couples) hash = FNV1a(hash, couple.c_str(), couple.size() + 1);
+	return hash;
+}
+
+void StartupCache::SelectPhysicsTables(){
+	G4VUserPhysicsList* physics = const_cast<G4VUserPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+	if(!IsEnabled() || !physics) return;
+	std::ostringstream name;
+	name << fDirectory << "physics-" << G4VERSION_NUMBER;
+	if(fPhysicsConfiguration != "") name << "-" << fPhysicsConfiguration;
+	name << "-" << std::hex << CouplesHash();
+	fPhysicsDirectory = name.str();
+	if(std::ifstream(fPhysicsDirectory + "/stored").good()){
+		physics->SetPhysicsTableRetrieved(fPhysicsDirectory);
+		fStorePhysics = false;
+		G4cout << "StartupCache: physics tables from " << fPhysicsDirectory << G4endl;
+	}
+	else{
+		physics->ResetPhysicsTableRetrieved();
+		fStorePhysics = true;
+	}
+}
+
+/// Stored aside and renamed: the first job to finish wins, the others
+/// drop their copy
+void StartupCache::StorePhysicsTables(){
+	if(!fStorePhysics) return;
+	fStorePhysics = false;
+	G4VUserPhysicsList* physics = const_cast<G4VUserPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+	G4String temporary = fPhysicsDirectory + ".tmp" + std::to_string(getpid());
+	mkdir(temporary.c_str(), 0755);
+	if(!physics || !physics->StorePhysicsTable(temporary)){
+		G4Exception("StartupCache::StorePhysicsTables", "Cache001", JustWarning, ("Cannot store the physics tables in " + temporary).c_str());
+		RemoveDirectory(temporary);
+		return;
+	}
+	std::ofstream(temporary + "/stored") << G4VERSION_NUMBER << std::endl;
+	if(rename(temporary.c_str(), fPhysicsDirectory.c_str()) != 0){
+		RemoveDirectory(temporary);
+		return;
+	}
+	G4cout << "StartupCache: physics tables stored in " << fPhysicsDirectory << G4endl;
+}
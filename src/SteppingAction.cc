@@ -0,0 +1,53 @@
+/// \file  SteppingAction.cc
+/// \brief Implementation of the SteppingAction class
+
+#include "SteppingAction.hh"
+
+#include "G4Step.hh"
+#include "G4Region.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4AutoLock.hh"
+
+namespace {
+	G4Mutex stepsMutex = G4MUTEX_INITIALIZER;
+}
+
+std::map<G4String, G4long> SteppingAction::fRunSteps;
+
+SteppingAction::SteppingAction() : G4UserSteppingAction(), fLast(0){}
+
+SteppingAction::~SteppingAction(){}
+
+void SteppingAction::UserSteppingAction(const G4Step* step){
+	const G4Region* region = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+	// consecutive steps are mostly in the same region
+	if(fLast < fCounts.size() && fCounts[fLast].region == region){
+		fCounts[fLast].steps++;
+		return;
+	}
+	for(fLast = 0; fLast < fCounts.size(); fLast++){
+		if(fCounts[fLast].region == region) break;
+	}
+	if(fLast == fCounts.size()) fCounts.push_back(Count{region, 0});
+	fCounts[fLast].steps++;
+}
+
+void SteppingAction::EndOfRun(){
+	G4AutoLock lock(&stepsMutex);
+	for(auto& count : fCounts) fRunSteps[count.region->GetName()] += count.steps;
+	fCounts.clear();
+	fLast = 0;
+}
+
+void SteppingAction::PrintRegionSteps(){
+	G4AutoLock lock(&stepsMutex);
+	G4long total = 0;
+	for(auto& steps : fRunSteps) total += steps.second;
+	if(total == 0) return;
+	G4cout << "Steps per region:" << G4endl;
+	for(auto& steps : fRunSteps){
+		G4cout << "  " << steps.first << ": " << steps.second << " (" << 100. * steps.second / total << " %)" << G4endl;
+	}
+	fRunSteps.clear();
+}
@@ -0,0 +1,82 @@
+/// \file  SweepMessenger.cc
+/// \brief Implementation of the SweepMessenger class
+
+#include "SweepMessenger.hh"
+#include "ParameterSweep.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+
+SweepMessenger::SweepMessenger(ParameterSweep* sweep) : G4UImessenger(), fSweep(sweep){
+	fSweepDirectory = new G4UIdirectory("/Element/sweep/");
+	fSweepDirectory->SetGuidance("Runs of several configurations in the same process.");
+
+	fCmdAdd = new G4UIcmdWithAString("/Element/sweep/add", this);
+	fCmdAdd->SetGuidance("Add a parameter to the grid with its values, e.g. CrysSize 0.025 0.05 0.1 (mm)");
+	fCmdAdd->SetGuidance("CrysSize [mm], CrysMaterial, SiPMmodel, Angle [deg], AngleWOG [deg], Tilt [mm], Ground, Energy [MeV], Particle or a UI command.");
+	fCmdAdd->SetParameterName("values", false);
+	fCmdAdd->AvailableForStates(G4State_Idle);
+
+	fCmdList = new G4UIcmdWithAString("/Element/sweep/list", this);
+	fCmdList->SetGuidance("Read the points from a file: the parameter names, then one point per line.");
+	fCmdList->SetParameterName("file", false);
+	fCmdList->AvailableForStates(G4State_Idle);
+
+	fCmdClear = new G4UIcmdWithoutParameter("/Element/sweep/clear", this);
+	fCmdClear->SetGuidance("Remove all the points.");
+	fCmdClear->AvailableForStates(G4State_Idle);
+
+	fCmdRun = new G4UIcommand("/Element/sweep/run", this);
+	fCmdRun->SetGuidance("Run the given number of events for each point, prefix_<name>-<value>...root are written.");
+	G4UIparameter* events = new G4UIparameter("events", 'i', false);
+	events->SetParameterRange("events > 0");
+	fCmdRun->SetParameter(events);
+	G4UIparameter* prefix = new G4UIparameter("prefix", 's', true);
+	prefix->SetDefaultValue("sweep");
+	fCmdRun->SetParameter(prefix);
+	fCmdRun->AvailableForStates(G4State_Idle);
+
+	// the sweep lives in the master, it drives the workers through the
+	// commands it applies
+	fCmdAdd->SetToBeBroadcasted(false);
+	fCmdList->SetToBeBroadcasted(false);
+	fCmdClear->SetToBeBroadcasted(false);
+	fCmdRun->SetToBeBroadcasted(false);
+}
+
+SweepMessenger::~SweepMessenger(){
+	delete fCmdAdd;
+	delete fCmdList;
+	delete fCmdClear;
+	delete fCmdRun;
+	delete fSweepDirectory;
+}
+
+void SweepMessenger::SetNewValue(G4UIcommand* command, G4String newValue){
+	std::istringstream is(newValue);
+	if(command == fCmdAdd){
+		G4String name;
+		std::vector<G4String> values;
+		std::string value;
+		is >> name;
+		while(is >> value) values.push_back(value);
+		fSweep->AddAxis(name, values);
+	}
+	else if(command == fCmdList){
+		fSweep->LoadList(newValue);
+	}
+	else if(command == fCmdClear){
+		fSweep->Clear();
+	}
+	else if(command == fCmdRun){
+		G4int events;
+		G4String prefix;
+		is >> events >> prefix;
+		fSweep->Run(events, prefix);
+	}
+}